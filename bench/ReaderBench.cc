@@ -0,0 +1,176 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <filesystem>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "Reader.h"
+#include "Exceptions.h"
+
+/** @file ReaderBench.cc
+ * @brief Benchmark of the CSV matrix reader against the previous implementation.
+ *
+ * Usage: ./bench_reader [--threads N] [sizes...]
+ * Writes a random complex n x n CSV file for each size (default 1000 and 2000) to the
+ * temporary directory, reads it with the previous reader and with the current one on
+ * 1 and N threads (default: all hardware threads), and reports the largest error of
+ * both readers against the matrix that was written.
+ */
+
+/// Previous parseComplex: strips blanks and splits the string around the signs
+std::complex<double> legacyParseComplex(std::string s)
+{
+    s.erase(remove_if(s.begin(), s.end(), isspace), s.end());
+    std::size_t delim_pos = s.find('i');
+    double real, imm;
+    if (delim_pos == std::string::npos) {
+        real = std::stod(s);
+        return std::complex<double>(real, 0);
+    }
+    if (s == "i") {
+        return std::complex<double>(0.0, 1.0);
+    } else if (s == "-i") {
+        return std::complex<double>(0.0, -1.0);
+    }
+    std::size_t plus_pos = s.find_last_of('+');
+    std::size_t min_pos = s.find_last_of('-');
+    if (plus_pos != std::string::npos && delim_pos - plus_pos == 1) {
+        real = std::stod(s.substr(0,plus_pos));
+        imm = 1;
+    }
+    else if (min_pos != std::string::npos && delim_pos - min_pos == 1) {
+        real = std::stod(s.substr(0,min_pos));
+        imm = -1;
+    }
+    else if (plus_pos != std::string::npos){
+        real = std::stod(s.substr(0,plus_pos));
+        imm = std::stod(s.substr(plus_pos, delim_pos-1));
+    }
+    else if (min_pos != std::string::npos && min_pos > 0) {
+        real = std::stod(s.substr(0, min_pos));
+        imm = std::stod(s.substr(min_pos, delim_pos-1));
+    }
+    else {
+        real = 0;
+        imm = std::stod(s.substr(0,delim_pos));
+    }
+    return std::complex<double>(real, imm);
+}
+
+/// Previous FileReader::genMatrix: counts rows and columns, seeks back, then parses with getline
+Eigen::MatrixXcd legacyReadCSV(std::string const& file_path)
+{
+    std::ifstream file(file_path);
+    long size = 0;
+    std::string line;
+    int expected_columns = 0;
+    while (std::getline(file, line)) {
+        if (size == 0) {
+            std::stringstream ss(line);
+            std::string cell;
+            while (std::getline(ss, cell, ',')) {
+                expected_columns++;
+            }
+        }
+        size++;
+    }
+    if (size != expected_columns) {
+        throw ReaderError("The matrix is not square.");
+    }
+    file.clear();
+    file.seekg(0);
+
+    Eigen::MatrixXcd A(size, size);
+    long row = 0;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        long col = 0;
+        while (getline(ss, cell, ',') && col < size) {
+            A(row, col) = legacyParseComplex(cell);
+            col++;
+        }
+        row++;
+    }
+    return A;
+}
+
+/// Seconds elapsed since start
+double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        }
+        else {
+            sizes.push_back(std::atoi(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 2000};
+    }
+
+    std::cout << "CSV reader benchmark" << std::endl;
+    std::cout << std::setw(8) << "n" << std::setw(12) << "size [MB]" << std::setw(14) << "legacy [s]"
+              << std::setw(14) << "1 thread [s]" << std::setw(14) << (std::to_string(threads) + " thr. [s]") << std::setw(10) << "speedup"
+              << std::setw(14) << "legacy error" << std::setw(14) << "reader error" << std::endl;
+
+    for (int n : sizes) {
+        // Random complex matrix in the "a+bi" format
+        std::filesystem::path path = std::filesystem::temp_directory_path() / ("pcsc_bench_" + std::to_string(n) + ".csv");
+        Eigen::MatrixXcd written(n, n);
+        {
+            std::mt19937 gen(n);
+            std::uniform_real_distribution<double> dist(-100.0, 100.0);
+            std::ofstream out(path);
+            out << std::setprecision(17);
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) {
+                    double re = dist(gen), im = dist(gen);
+                    written(i, j) = Eigen::dcomplex(re, im);
+                    out << re << (im < 0 ? "-" : "+") << std::abs(im) << "i" << (j + 1 < n ? "," : "\n");
+                }
+            }
+        }
+        double megabytes = std::filesystem::file_size(path) / 1e6;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Eigen::MatrixXcd legacy = legacyReadCSV(path.string());
+        double legacy_time = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        FileReader serial_reader("QR", 1, 1e-9, nlohmann::json(), path.string(), 1);
+        serial_reader.genMatrix();
+        double serial_time = secondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        FileReader reader("QR", 1, 1e-9, nlohmann::json(), path.string(), threads);
+        reader.genMatrix();
+        double reader_time = secondsSince(start);
+
+        double legacy_error = (legacy - written).cwiseAbs().maxCoeff();
+        double reader_error = (reader.getInputData().input_matrix - written).cwiseAbs().maxCoeff();
+        std::cout << std::setw(8) << n << std::setw(12) << std::fixed << std::setprecision(1) << megabytes
+                  << std::setw(14) << std::setprecision(3) << legacy_time << std::setw(14) << serial_time
+                  << std::setw(14) << reader_time
+                  << std::setw(10) << std::setprecision(1) << legacy_time / reader_time
+                  << std::setw(14) << std::scientific << std::setprecision(2) << legacy_error
+                  << std::setw(14) << reader_error << std::endl;
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+#include "Solver.h"
+#include "test_utils.h"
+
+/** @file SolverBench.cc
+ * @brief Benchmarks comparing the solvers on random matrices.
+ *
+ * Usage: ./bench_pcsc [--qr-iters N] [sizes...]
+ * The default sizes are 500, 2000 and 5000. The plain QR method is capped at
+ * --qr-iters iterations (default 100), since it does not converge in reasonable
+ * time for large matrices; its time per iteration is reported as well.
+ * The acceleration benchmark runs the power and inverse methods with every acceleration
+ * on the matrices of the solver tests, then on a matrix whose dominant eigenvalue 10.5 is
+ * close to the rest of the spectrum [1, 10]. CHEBYSHEV and MOMENTUM need a real spectrum
+ * of the unwanted eigenvalues, so they are skipped for the test matrices with complex ones.
+ */
+
+/// Run a solver and print one row of the results table, labelled with the method name unless a label is given
+void runBench(Solver & solver, int n, std::string const& label = "")
+{
+    solver.solve();
+    OutputData out = solver.getOutput();
+    std::cout << std::setw(8) << n << "  " << std::setw(38) << std::left << (label.empty() ? out.method : label) << std::right
+              << std::setw(14) << std::fixed << std::setprecision(3) << out.execution_time / 1e6
+              << std::setw(10) << out.iterations
+              << std::setw(14) << std::scientific << std::setprecision(2) << out.estimated_error
+              << std::setw(14) << out.execution_time / 1e6 / std::max(out.iterations, 1) << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    int qr_iters = 100;
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--qr-iters" && i + 1 < argc) {
+            qr_iters = std::atoi(argv[++i]);
+        }
+        else {
+            sizes.push_back(std::atoi(argv[i]));
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {500, 2000, 5000};
+    }
+
+    auto printHeader = []() {
+        std::cout << std::setw(8) << "n" << "  " << std::setw(38) << std::left << "method" << std::right
+              << std::setw(14) << "time [s]" << std::setw(10) << "iters"
+              << std::setw(14) << "error" << std::setw(14) << "s / iter" << std::endl;
+    };
+    std::cout << "Hermitian benchmark" << std::endl;
+    printHeader();
+
+    for (int n : sizes) {
+        std::srand(n);
+        Eigen::MatrixXcd B = Eigen::MatrixXcd::Random(n, n);
+        InputData input;
+        input.size = n;
+        input.tol = 1e-9;
+        input.input_matrix = B + B.adjoint();
+        B.resize(0, 0);
+
+        input.num_iters = 1;
+        input.method_config["THREADS"] = 0;
+        HermitianSolver hermitian(input);
+        runBench(hermitian, n);
+
+        input.num_iters = 100 * n;
+        ShiftedQRSolver shifted_qr(input);
+        runBench(shifted_qr, n);
+
+        input.num_iters = qr_iters;
+        QRSolver qr(input);
+        runBench(qr, n);
+    }
+
+    std::cout << std::endl << "Acceleration benchmark, solver test matrices" << std::endl;
+    std::srand(0);
+    Matrices matrices;
+    std::vector<std::tuple<std::string, Eigen::MatrixXcd, double>> test_matrices = {
+        {"random 3x3", matrices.getRandom3(), 0}, {"random 5x5", matrices.getRandom5(), 0},
+        {"identity", matrices.getIdentity(), 0}, {"real diagonal", matrices.getDiagonalReal(), 0},
+        {"complex diagonal", matrices.getDiagonalComplex(), 3}, {"symmetric", matrices.getSymmetric(), 0}
+    };
+    for (auto const& [name, A, shift] : test_matrices) {
+        int n = A.rows();
+        InputData input;
+        input.size = n;
+        input.num_iters = 100000;
+        input.tol = 1e-9;
+        input.input_matrix = A;
+        input.method_config["SHIFT"] = std::to_string(shift);
+        input.method_config["FACTORIZATION"] = "LU";
+
+        // Eigenvalues of A sorted by distance to the shift, the power method finds the first
+        Eigen::VectorXcd eigenvals = Eigen::ComplexEigenSolver<Eigen::MatrixXcd>(A).eigenvalues();
+        std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(eigenvals.array() - shift);
+        bool real = eigenvals.imag().isZero(1e-12);
+        std::cout << name << ", shift " << std::defaultfloat << shift
+                  << (real ? "" : ", complex spectrum: CHEBYSHEV and MOMENTUM skipped") << std::endl;
+        printHeader();
+        // Interval of the eigenvalues of A without the one at index wanted, empty if they are all equal
+        auto unwanted = [&](std::size_t wanted) {
+            std::vector<double> others;
+            for (std::size_t k = 0; k < sorted_eigenvals.size(); k++) {
+                if (k != wanted) {
+                    others.push_back(sorted_eigenvals[k].real() + shift);
+                }
+            }
+            return std::vector<double>{*std::min_element(others.begin(), others.end()), *std::max_element(others.begin(), others.end())};
+        };
+
+        for (std::string acceleration : {"NONE", "AITKEN", "CHEBYSHEV", "MOMENTUM"}) {
+            if (!real && (acceleration == "CHEBYSHEV" || acceleration == "MOMENTUM")) {
+                continue;
+            }
+            input.method_config["ACCELERATION"] = acceleration;
+            std::vector<double> bounds = unwanted(0);
+            input.method_config["BOUNDS"] = bounds;
+            input.method_config["BETA"] = std::norm(sorted_eigenvals[1]) / 4;
+            if (acceleration != "CHEBYSHEV" || bounds[0] < bounds[1]) {
+                PowerSolver power(input);
+                runBench(power, n, "Power, " + acceleration);
+            }
+            bounds = unwanted(sorted_eigenvals.size() - 1);
+            input.method_config["BOUNDS"] = bounds;
+            if (acceleration != "MOMENTUM" && (acceleration != "CHEBYSHEV" || (bounds[0] < bounds[1] && (bounds[0] > shift || bounds[1] < shift)))) {
+                InverseSolver inverse(input);
+                runBench(inverse, n, "Inverse, " + acceleration);
+            }
+        }
+    }
+
+    std::cout << std::endl << "Acceleration benchmark, clustered spectrum" << std::endl;
+    printHeader();
+    for (int n : sizes) {
+        std::srand(n);
+        Eigen::VectorXd eigenvals(n);
+        eigenvals << Eigen::VectorXd::LinSpaced(n - 1, 1, 10), 10.5;
+        InputData input = hermitianInput(eigenvals, 100000, 1e-9);
+        input.method_config["BOUNDS"] = {1, 10};
+        input.method_config["BETA"] = 25;
+        input.method_config["FACTORIZATION"] = "LU";
+
+        for (std::string acceleration : {"NONE", "AITKEN", "CHEBYSHEV", "MOMENTUM"}) {
+            input.method_config["ACCELERATION"] = acceleration;
+            input.method_config["SHIFT"] = "0";
+            PowerSolver power(input);
+            runBench(power, n, "Power, " + acceleration);
+            if (acceleration != "MOMENTUM") {
+                input.method_config["SHIFT"] = "11";
+                InverseSolver inverse(input);
+                runBench(inverse, n, "Inverse (shift 11), " + acceleration);
+            }
+        }
+    }
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+#include "BatchRunner.h"
+#include "ThreadPool.h"
+#include "Exceptions.h"
+#include "utils.h"
+
+/** @file BatchRunner.cc
+ * @brief Implementation file for running many configurations in one process.
+ */
+
+/**
+ * @brief BatchRunner constructor, collects the configurations of the batch.
+ *
+ * A directory contributes all of its *.json files in alphabetical order. Any other file
+ * is a manifest: every non-empty line not starting with '#' is a configuration path,
+ * relative to the manifest's directory unless absolute.
+ * @param batch_path Directory or manifest file.
+ * @param num_threads Number of worker threads, 0 uses all hardware threads.
+ */
+BatchRunner::BatchRunner(std::filesystem::path const& batch_path, int num_threads) : num_threads(num_threads)
+{
+    if (std::filesystem::is_directory(batch_path)) {
+        for (auto const& entry : std::filesystem::directory_iterator(batch_path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json") {
+                configs.push_back(entry.path());
+            }
+        }
+        std::sort(configs.begin(), configs.end());
+    }
+    else {
+        std::ifstream manifest(batch_path);
+        if (!manifest.is_open()) {
+            throw ConfigError("ERROR: Batch directory or manifest not found.");
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line.erase(0, line.find_first_not_of(" \t\r"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::filesystem::path config = line;
+            configs.push_back(config.is_absolute() ? config : batch_path.parent_path() / config);
+        }
+    }
+    if (configs.empty()) {
+        throw ConfigError("ERROR: Batch does not contain any configuration.");
+    }
+    results.resize(configs.size());
+}
+
+/**
+ * @brief Reads, solves and stores the result of a single configuration.
+ *
+ * Errors are recorded in the result instead of stopping the batch.
+ * @param j Index of the configuration.
+ */
+void BatchRunner::runJob(int j)
+{
+    BatchResult & result = results[j];
+    result.config = configs[j];
+    result.success = false;
+    try {
+        std::unique_ptr<Reader> reader(createReader(configs[j]));
+        std::unique_ptr<Solver> solver(createSolver(reader.get()));
+        solver->solve();
+        result.output = solver->getOutput();
+        result.success = true;
+    }
+    catch (const ConfigError &e) {
+        result.error = std::string("Configuration File error: ") + e.what();
+    }
+    catch (const ReaderError &e) {
+        result.error = std::string("Reader error: ") + e.what();
+    }
+    catch (const std::exception &e) {
+        result.error = e.what();
+    }
+}
+
+/**
+ * @brief Runs every configuration of the batch on a work-stealing thread pool.
+ */
+void BatchRunner::run()
+{
+    ThreadPool pool(num_threads);
+    for (int j=0; j<(int)configs.size(); j++) {
+        pool.submit([this, j]() { runJob(j); });
+    }
+    pool.wait();
+    std::cout << "Batch finished: " << configs.size() - numFailed() << " of " << configs.size()
+        << " jobs succeeded." << std::endl;
+}
+
+/**
+ * @brief Method to get the results of the batch
+ * @return Vector with one BatchResult per configuration
+ */
+std::vector<BatchResult> BatchRunner::getResults() const
+{
+    return results;
+}
+
+/**
+ * @brief Number of failed jobs.
+ * @return Number of configurations that could not be read or solved.
+ */
+int BatchRunner::numFailed() const
+{
+    return std::count_if(results.begin(), results.end(), [](BatchResult const& r) { return !r.success; });
+}
+
+/**
+ * @brief Quotes a field for the CSV output.
+ * @param field The field to quote.
+ * @return 'std::string' with the field in double quotes, inner quotes doubled.
+ */
+static std::string quoteCSV(std::string const& field)
+{
+    std::string quoted = "\"";
+    for (char c : field) {
+        quoted += (c == '"') ? "\"\"" : std::string(1, c);
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Writes batch results to a single CSV file.
+ *
+ * One row per eigenvalue, with the configuration, the method and the solver metrics.
+ * A failed job gives a single row with status FAILED and the error message.
+ * @param results Results of the jobs, in the order of the rows.
+ * @param out_path std::string containing the output file path
+ */
+void saveBatchResults(std::vector<BatchResult> const& results, std::string const& out_path)
+{
+    std::ofstream out_file(out_path, std::ios::out);
+    if (!out_file) {
+        throw ConfigError("ERROR: Could not open the batch output file.");
+    }
+    out_file.precision(15);
+    out_file << "config,status,method,index,real,imag,estimated_error,execution_time,iterations\n";
+    for (auto const& r : results) {
+        std::string config = quoteCSV(r.config.string());
+        if (!r.success) {
+            out_file << config << ",FAILED," << quoteCSV(r.error) << ",,,,,,\n";
+            continue;
+        }
+        OutputData const& out = r.output;
+        for (int i=0; i<out.estimated_eigenvalues.size(); i++) {
+            out_file << config << ",OK," << quoteCSV(out.method) << "," << i << ","
+                << out.estimated_eigenvalues[i].real() << "," << out.estimated_eigenvalues[i].imag() << ","
+                << out.estimated_error << "," << out.execution_time << "," << out.iterations << "\n";
+        }
+    }
+    out_file.close();
+    std::cout << "Batch output saved to " << out_path << std::endl;
+}
+
+/**
+ * @brief Writes the results of all jobs to a single CSV file.
+ * @param out_path std::string containing the output file path
+ */
+void BatchRunner::saveOutput(std::string const& out_path) const
+{
+    saveBatchResults(results, out_path);
+}
@@ -0,0 +1,75 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "OutputData.h"
+
+/** @file BatchRunner.h
+ * @brief Header file for running many configurations in one process.
+ */
+
+/**
+ * @struct BatchResult
+ * @brief Outcome of a single configuration of a batch.
+ */
+struct BatchResult {
+    std::filesystem::path config; /// Path of the configuration file
+    bool success; /// False if reading or solving failed
+    std::string error; /// Error message of a failed job
+    OutputData output; /// Output of the solver of a successful job
+};
+
+/**
+ * @class BatchRunner
+ * @brief Runs read, solve and output for many configuration files on a work-stealing thread pool.
+ */
+class BatchRunner
+{
+protected:
+    std::vector<std::filesystem::path> configs; /// Configuration files, one job each
+    int num_threads; /// Number of worker threads
+    std::vector<BatchResult> results; /// Results, in the order of the configurations
+    /**
+     * @brief Reads, solves and stores the result of a single configuration.
+     * @param j Index of the configuration.
+     */
+    void runJob(int j);
+public:
+    /**
+     * @brief BatchRunner constructor
+     * @param batch_path Directory containing the *.json configurations, or manifest file
+     * listing one configuration path per line (relative to the manifest).
+     * @param num_threads Number of worker threads, 0 uses all hardware threads.
+     */
+    BatchRunner(std::filesystem::path const& batch_path, int num_threads);
+    /**
+     * @brief Runs every configuration of the batch.
+     */
+    void run();
+    /**
+     * @brief Method to get the results of the batch
+     * @return Vector with one BatchResult per configuration
+     */
+    std::vector<BatchResult> getResults() const;
+    /**
+     * @brief Number of failed jobs.
+     * @return Number of configurations that could not be read or solved.
+     */
+    int numFailed() const;
+    /**
+     * @brief Writes the results of all jobs to a single CSV file.
+     * @param out_path std::string containing the output file path
+     */
+    void saveOutput(std::string const& out_path) const;
+};
+
+/**
+ * @brief Writes batch results to a single CSV file, one row per eigenvalue or failed job.
+ * @param results Results of the jobs, in the order of the rows.
+ * @param out_path std::string containing the output file path
+ */
+void saveBatchResults(std::vector<BatchResult> const& results, std::string const& out_path);
+
+#endif //BATCHRUNNER_H
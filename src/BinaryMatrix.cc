@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <limits>
+#include "BinaryMatrix.h"
+#include "Exceptions.h"
+
+/** @file BinaryMatrix.cc
+ * @brief Implementation file for the binary matrix format.
+ */
+
+/**
+ * @brief Validates the header of a binary matrix file.
+ * @param header The header read from the file.
+ * @param file_size Size of the whole file in bytes.
+ * @param path Path of the file, for the error messages.
+ * @return Size of one entry in bytes.
+ * @throws ReaderError if the header is invalid or the file is truncated.
+ */
+static std::size_t checkHeader(BinaryMatrixHeader const& header, std::size_t file_size, std::string const& path)
+{
+    if (std::memcmp(header.magic, BINARY_MATRIX_MAGIC, sizeof(header.magic)) != 0) {
+        throw ReaderError("Not a binary matrix file: " + path);
+    }
+    if (header.version != BINARY_MATRIX_VERSION) {
+        throw ReaderError("Unsupported binary matrix version " + std::to_string(header.version));
+    }
+    if (header.dtype != FLOAT64 && header.dtype != COMPLEX128) {
+        throw ReaderError("Unsupported binary matrix dtype " + std::to_string(header.dtype));
+    }
+    if (header.layout != COLUMN_MAJOR && header.layout != ROW_MAJOR) {
+        throw ReaderError("Unsupported binary matrix layout " + std::to_string(header.layout));
+    }
+    if (header.rows != header.cols) {
+        throw ReaderError("The matrix is not square. Rows: " + std::to_string(header.rows) + ", Columns: " + std::to_string(header.cols));
+    }
+    if (header.rows <= 0) {
+        throw ReaderError("Error: size must be positive.");
+    }
+    if (header.rows > std::numeric_limits<int>::max()) {
+        throw ReaderError("Binary matrix size " + std::to_string(header.rows) + " is too large.");
+    }
+    std::size_t entry_size = (header.dtype == COMPLEX128) ? sizeof(Eigen::dcomplex) : sizeof(double);
+    // Divide instead of multiplying, so that a corrupt size cannot overflow the check
+    std::size_t rows = header.rows;
+    if ((file_size - sizeof(header)) / entry_size / rows < rows) {
+        throw ReaderError("Truncated binary matrix file: " + path);
+    }
+    return entry_size;
+}
+
+/**
+ * @brief Maps a binary matrix file as an operator.
+ *
+ * The header is validated and the entries are viewed in place, so loading does not
+ * depend on the size of the matrix.
+ * @param path Path of the binary matrix file.
+ * @return Shared pointer to a MappedOperator viewing the file.
+ */
+std::shared_ptr<LinearOperator> mapBinaryMatrix(std::string const& path)
+{
+    auto file = std::make_shared<const MappedFile>(path);
+    if (file->size() < sizeof(BinaryMatrixHeader)) {
+        throw ReaderError("Missing binary matrix header in " + path);
+    }
+    BinaryMatrixHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    checkHeader(header, file->size(), path);
+    long n = header.rows;
+
+    const char * entries = file->data() + sizeof(header);
+    if (header.dtype == COMPLEX128 && header.layout == COLUMN_MAJOR) {
+        return std::make_shared<MappedOperator<Eigen::dcomplex, Eigen::ColMajor>>(file, reinterpret_cast<const Eigen::dcomplex *>(entries), n);
+    }
+    else if (header.dtype == COMPLEX128) {
+        return std::make_shared<MappedOperator<Eigen::dcomplex, Eigen::RowMajor>>(file, reinterpret_cast<const Eigen::dcomplex *>(entries), n);
+    }
+    else if (header.layout == COLUMN_MAJOR) {
+        return std::make_shared<MappedOperator<double, Eigen::ColMajor>>(file, reinterpret_cast<const double *>(entries), n);
+    }
+    else {
+        return std::make_shared<MappedOperator<double, Eigen::RowMajor>>(file, reinterpret_cast<const double *>(entries), n);
+    }
+}
+
+/**
+ * @brief Writes a matrix in the binary matrix format, column-major.
+ * @param A The matrix to write.
+ * @param path Path of the output file.
+ * @param real If true the entries are stored as FLOAT64 and their imaginary parts dropped.
+ */
+void writeBinaryMatrix(Eigen::MatrixXcd const& A, std::string const& path, bool real)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw ReaderError("Error opening file for writing: " + path);
+    }
+    BinaryMatrixHeader header = {};
+    std::memcpy(header.magic, BINARY_MATRIX_MAGIC, sizeof(header.magic));
+    header.version = BINARY_MATRIX_VERSION;
+    header.dtype = real ? FLOAT64 : COMPLEX128;
+    header.layout = COLUMN_MAJOR;
+    header.rows = A.rows();
+    header.cols = A.cols();
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if (real) {
+        // One column at a time, so that the real part is never held in full
+        Eigen::VectorXd column(A.rows());
+        for (long col = 0; col < A.cols() && out; col++) {
+            column = A.col(col).real();
+            out.write(reinterpret_cast<const char *>(column.data()), sizeof(double) * column.size());
+        }
+    }
+    else {
+        out.write(reinterpret_cast<const char *>(A.data()), sizeof(Eigen::dcomplex) * A.size());
+    }
+    if (!out) {
+        throw ReaderError("Error writing binary matrix file: " + path);
+    }
+}
+
+/**
+ * @brief Multiplies one block of the matrix, read from the file, with a block of vectors.
+ *
+ * A block of rows gives the matching rows of Y. A block of columns is multiplied by the
+ * matching rows of X and accumulated into Y. Real entries are multiplied with the real
+ * and imaginary parts of X separately.
+ * @tparam Scalar Type of the stored entries, double or Eigen::dcomplex.
+ * @tparam Layout Eigen::ColMajor or Eigen::RowMajor.
+ * @param data Entries of the block.
+ * @param n Number of rows and columns of the matrix.
+ * @param first First row or column of the block.
+ * @param count Number of rows or columns in the block.
+ * @param X Input block of vectors.
+ * @param X_real Real part of X, only used for real entries.
+ * @param X_imag Imaginary part of X, only used for real entries.
+ * @param Y Output block.
+ */
+template <typename Scalar, int Layout>
+static void multiplyBlock(const char * data, long n, long first, long count, Eigen::Ref<const Eigen::MatrixXcd> X,
+    Eigen::MatrixXd const& X_real, Eigen::MatrixXd const& X_imag, Eigen::Ref<Eigen::MatrixXcd> Y)
+{
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Layout> BlockType;
+    constexpr bool row_major = (Layout == Eigen::RowMajor);
+    Eigen::Map<const BlockType> block(reinterpret_cast<const Scalar *>(data), row_major ? count : n, row_major ? n : count);
+    if constexpr (std::is_same_v<Scalar, Eigen::dcomplex> && row_major) {
+        Y.middleRows(first, count).noalias() = block * X;
+    }
+    else if constexpr (std::is_same_v<Scalar, Eigen::dcomplex>) {
+        Y.noalias() += block * X.middleRows(first, count);
+    }
+    else if constexpr (row_major) {
+        Eigen::MatrixXd Y_real = block * X_real;
+        Eigen::MatrixXd Y_imag = block * X_imag;
+        Y.middleRows(first, count).real() = Y_real;
+        Y.middleRows(first, count).imag() = Y_imag;
+    }
+    else {
+        Eigen::MatrixXd Y_real = block * X_real.middleRows(first, count);
+        Eigen::MatrixXd Y_imag = block * X_imag.middleRows(first, count);
+        Y.real() += Y_real;
+        Y.imag() += Y_imag;
+    }
+}
+
+/**
+ * @brief OutOfCoreOperator constructor
+ *
+ * Validates the header and sizes the two block buffers so that together they fit in
+ * the budget. A block holds at least one row or column, even if that exceeds the budget.
+ * @param path Path of the binary matrix file.
+ * @param budget Memory budget in bytes for the two block buffers.
+ */
+OutOfCoreOperator::OutOfCoreOperator(std::string const& path, std::size_t budget)
+    : path(path), file(path, std::ios::binary), bytes_streamed(0), read_time(0), stream_time(0)
+{
+    if (!file.is_open()) {
+        throw ReaderError("Error opening file: " + path);
+    }
+    file.seekg(0, std::ios::end);
+    std::size_t file_size = file.tellg();
+    file.seekg(0);
+    if (file_size < sizeof(BinaryMatrixHeader)) {
+        throw ReaderError("Missing binary matrix header in " + path);
+    }
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    std::size_t entry_size = checkHeader(header, file_size, path);
+    n = header.rows;
+
+    std::size_t line_bytes = entry_size * n;
+    block_size = std::min<long>(n, budget / 2 / line_bytes);
+    if (block_size < 1) {
+        std::cerr << "WARNING: Block budget smaller than two rows of the matrix. Using blocks of one row." << std::endl << std::flush;
+        block_size = 1;
+    }
+    block_bytes = line_bytes * block_size;
+    buffers[0].resize(block_bytes);
+    buffers[1].resize(block_bytes);
+}
+
+/// Number of rows (and columns) of the streamed matrix
+int OutOfCoreOperator::size() const
+{
+    return n;
+}
+
+/// Number of rows or columns read at once
+long OutOfCoreOperator::getBlockSize() const
+{
+    return block_size;
+}
+
+/**
+ * @brief Reads a block of the matrix.
+ * @param block Index of the block, the last one may be shorter.
+ * @param buffer Buffer receiving the entries of the block.
+ * @return Time spent reading, in seconds.
+ * @throws ReaderError if the file cannot be read.
+ */
+double OutOfCoreOperator::readBlock(long block, std::vector<char> & buffer) const
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::size_t line_bytes = block_bytes / block_size;
+    long count = std::min(block_size, n - block * block_size);
+    file.seekg(sizeof(BinaryMatrixHeader) + static_cast<std::streamoff>(block) * block_bytes);
+    file.read(buffer.data(), line_bytes * count);
+    if (!file) {
+        throw ReaderError("Error reading binary matrix file: " + path);
+    }
+    bytes_streamed += line_bytes * count;
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+/**
+ * @brief Computes @f$ Y = A X @f$ in one pass over the file.
+ *
+ * The first block is read before the loop. Each iteration then starts reading the next
+ * block into the other buffer on a prefetch thread, multiplies the current block, and
+ * waits for the prefetch.
+ * @param X Input block, one vector per column.
+ * @param Y Output block.
+ */
+void OutOfCoreOperator::stream(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Eigen::MatrixXd X_real, X_imag;
+    if (header.dtype == FLOAT64) {
+        X_real = X.real();
+        X_imag = X.imag();
+    }
+    if (header.layout == COLUMN_MAJOR) {
+        Y.setZero();
+    }
+
+    long num_blocks = (n + block_size - 1) / block_size;
+    read_time += readBlock(0, buffers[0]);
+    for (long b = 0; b < num_blocks; b++) {
+        std::future<double> prefetch;
+        if (b + 1 < num_blocks) {
+            prefetch = std::async(std::launch::async, &OutOfCoreOperator::readBlock, this, b + 1, std::ref(buffers[(b + 1) % 2]));
+        }
+        const char * data = buffers[b % 2].data();
+        long first = b * block_size;
+        long count = std::min(block_size, n - first);
+        if (header.dtype == COMPLEX128 && header.layout == ROW_MAJOR) {
+            multiplyBlock<Eigen::dcomplex, Eigen::RowMajor>(data, n, first, count, X, X_real, X_imag, Y);
+        }
+        else if (header.dtype == COMPLEX128) {
+            multiplyBlock<Eigen::dcomplex, Eigen::ColMajor>(data, n, first, count, X, X_real, X_imag, Y);
+        }
+        else if (header.layout == ROW_MAJOR) {
+            multiplyBlock<double, Eigen::RowMajor>(data, n, first, count, X, X_real, X_imag, Y);
+        }
+        else {
+            multiplyBlock<double, Eigen::ColMajor>(data, n, first, count, X, X_real, X_imag, Y);
+        }
+        if (prefetch.valid()) {
+            read_time += prefetch.get();
+        }
+    }
+    stream_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+/**
+ * @brief Applies the streamed matrix to a vector.
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x @f$.
+ */
+void OutOfCoreOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    stream(Eigen::Map<const Eigen::MatrixXcd>(x.data(), n, 1), Eigen::Map<Eigen::MatrixXcd>(y.data(), n, 1));
+}
+
+/**
+ * @brief Applies the streamed matrix to a block of vectors, still in a single pass over the file.
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X @f$.
+ */
+void OutOfCoreOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    stream(X, Y);
+}
+
+/**
+ * @brief Builds the dense matrix in a single pass over the file.
+ * @return 'Eigen::MatrixXcd' containing the whole matrix.
+ */
+Eigen::MatrixXcd OutOfCoreOperator::toDense() const
+{
+    Eigen::MatrixXcd M(n, n);
+    stream(Eigen::MatrixXcd::Identity(n, n), M);
+    return M;
+}
+
+/**
+ * @brief Adds the streaming statistics to a solver's output.
+ *
+ * The stream throughput counts the whole time spent in products, the read throughput
+ * only the time spent in reads. When the two are close the products are bound by the
+ * sequential read speed of the disk, not by the multiplications.
+ * @param metrics (name, value) pairs to append to.
+ */
+void OutOfCoreOperator::reportMetrics(std::vector<std::pair<std::string, std::string>> & metrics) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.emplace_back("Block Size", std::to_string(block_size) + (header.layout == ROW_MAJOR ? " rows" : " columns"));
+    metrics.emplace_back("Streamed Data", std::to_string(bytes_streamed / 1e9) + " GB");
+    metrics.emplace_back("Stream Throughput", std::to_string(stream_time > 0 ? bytes_streamed / stream_time / 1e9 : 0.0) + " GB/s");
+    metrics.emplace_back("Read Throughput", std::to_string(read_time > 0 ? bytes_streamed / read_time / 1e9 : 0.0) + " GB/s");
+}
@@ -0,0 +1,190 @@
+#ifndef BINARYMATRIX_H
+#define BINARYMATRIX_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Dense>
+#include "LinearOperator.h"
+#include "MappedFile.h"
+
+/** @file BinaryMatrix.h
+ * @brief Header file for the binary matrix format and its memory-mapped operator.
+ *
+ * A binary matrix file is a 64 byte BinaryMatrixHeader followed by the raw entries,
+ * little-endian, in the layout given by the header.
+ */
+
+/// Magic bytes at the start of a binary matrix file
+static constexpr char BINARY_MATRIX_MAGIC[8] = {'P', 'C', 'S', 'C', 'M', 'A', 'T', '\0'};
+/// Current version of the binary matrix format
+static constexpr std::uint32_t BINARY_MATRIX_VERSION = 1;
+
+/// Type of the entries of a binary matrix
+enum BinaryMatrixDtype : std::uint32_t {
+    FLOAT64 = 0,   ///< Real entries, 8 bytes each
+    COMPLEX128 = 1 ///< Complex entries, real and imaginary part interleaved, 16 bytes each
+};
+
+/// Storage order of the entries of a binary matrix
+enum BinaryMatrixLayout : std::uint32_t {
+    COLUMN_MAJOR = 0, ///< Columns stored one after the other, as Eigen does by default
+    ROW_MAJOR = 1     ///< Rows stored one after the other, as in a CSV file
+};
+
+/**
+ * @struct BinaryMatrixHeader
+ * @brief Header of a binary matrix file.
+ */
+struct BinaryMatrixHeader {
+    char magic[8]; /// BINARY_MATRIX_MAGIC
+    std::uint32_t version; /// Format version
+    std::uint32_t dtype; /// BinaryMatrixDtype of the entries
+    std::uint32_t layout; /// BinaryMatrixLayout of the entries
+    std::uint32_t reserved; /// Unused, 0
+    std::int64_t rows; /// Number of rows
+    std::int64_t cols; /// Number of columns
+    char padding[24]; /// Pads the header to 64 bytes, so that the entries are aligned
+};
+static_assert(sizeof(BinaryMatrixHeader) == 64, "The binary matrix header must be 64 bytes");
+
+/**
+ * @class MappedOperator
+ * @brief Operator viewing a matrix stored in a memory-mapped file, without copying it.
+ * @tparam Scalar Type of the stored entries, double or Eigen::dcomplex.
+ * @tparam Layout Eigen::ColMajor or Eigen::RowMajor.
+ */
+template <typename Scalar, int Layout>
+class MappedOperator : public LinearOperator
+{
+    protected:
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Layout> MatrixType;
+        std::shared_ptr<const MappedFile> file; /// Mapped file, kept alive by the operator
+        Eigen::Map<const MatrixType> matrix; /// View of the entries in the mapped file
+    public:
+        /**
+         * @brief MappedOperator constructor
+         * @param mapped_file The mapped file.
+         * @param entries Pointer to the first entry inside the mapped file.
+         * @param n Number of rows and columns.
+         */
+        MappedOperator(std::shared_ptr<const MappedFile> mapped_file, const Scalar * entries, long n)
+            : file(mapped_file), matrix(entries, n, n) {}
+        /// MappedOperator destructor
+        ~MappedOperator() {};
+        int size() const override
+        {
+            return matrix.rows();
+        }
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override
+        {
+            if constexpr (std::is_same_v<Scalar, Eigen::dcomplex>) {
+                y.noalias() = matrix * x;
+            }
+            else {
+                // Real matrix, the real and imaginary parts are multiplied separately
+                Eigen::VectorXd x_real = x.real(), x_imag = x.imag();
+                Eigen::VectorXd y_real = matrix * x_real;
+                Eigen::VectorXd y_imag = matrix * x_imag;
+                y.real() = y_real;
+                y.imag() = y_imag;
+            }
+        }
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override
+        {
+            if constexpr (std::is_same_v<Scalar, Eigen::dcomplex>) {
+                Y.noalias() = matrix * X;
+            }
+            else {
+                Eigen::MatrixXd X_real = X.real(), X_imag = X.imag();
+                Eigen::MatrixXd Y_real = matrix * X_real;
+                Eigen::MatrixXd Y_imag = matrix * X_imag;
+                Y.real() = Y_real;
+                Y.imag() = Y_imag;
+            }
+        }
+        Eigen::MatrixXcd toDense() const override
+        {
+            return matrix.template cast<Eigen::dcomplex>();
+        }
+};
+
+/**
+ * @class OutOfCoreOperator
+ * @brief Operator streaming a binary matrix file from disk on every product.
+ *
+ * Only two blocks of the matrix are held in memory: whole rows for row-major files,
+ * whole columns for column-major files. While one block is multiplied, a prefetch
+ * thread reads the next one into the other buffer, so reading and computing overlap.
+ * Products are serialized, as the buffers and the file are shared.
+ */
+class OutOfCoreOperator : public LinearOperator
+{
+    protected:
+        std::string path; /// Path of the binary matrix file
+        BinaryMatrixHeader header; /// Header of the file
+        long n; /// Number of rows and columns
+        long block_size; /// Number of rows (row-major) or columns (column-major) per block
+        std::size_t block_bytes; /// Size of a full block in bytes
+        mutable std::ifstream file; /// Stream over the file, only read by the prefetch thread
+        mutable std::vector<char> buffers[2]; /// Double buffer for the blocks
+        mutable std::mutex mutex; /// Serializes the products
+        mutable double bytes_streamed; /// Total number of bytes read
+        mutable double read_time; /// Time spent reading, in seconds
+        mutable double stream_time; /// Time spent in products, in seconds
+        /**
+         * @brief Reads a block of the matrix.
+         * @param block Index of the block.
+         * @param buffer Buffer receiving the entries of the block.
+         * @return Time spent reading, in seconds.
+         */
+        double readBlock(long block, std::vector<char> & buffer) const;
+        /**
+         * @brief Computes @f$ Y = A X @f$ in one pass over the file.
+         * @param X Input block, one vector per column.
+         * @param Y Output block.
+         */
+        void stream(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const;
+    public:
+        /**
+         * @brief OutOfCoreOperator constructor
+         * @param path Path of the binary matrix file.
+         * @param budget Memory budget in bytes for the two block buffers.
+         * @throws ReaderError if the file is missing, not a binary matrix, not square or truncated.
+         */
+        OutOfCoreOperator(std::string const& path, std::size_t budget);
+        /// OutOfCoreOperator destructor
+        ~OutOfCoreOperator() {};
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override;
+        Eigen::MatrixXcd toDense() const override;
+        void reportMetrics(std::vector<std::pair<std::string, std::string>> & metrics) const override;
+        /**
+         * @brief Method to get the block size
+         * @return Number of rows or columns read at once
+         */
+        long getBlockSize() const;
+};
+
+/**
+ * @brief Maps a binary matrix file as an operator.
+ * @param path Path of the binary matrix file.
+ * @return Shared pointer to a MappedOperator viewing the file.
+ * @throws ReaderError if the file is missing, not a binary matrix, not square or truncated.
+ */
+std::shared_ptr<LinearOperator> mapBinaryMatrix(std::string const& path);
+
+/**
+ * @brief Writes a matrix in the binary matrix format, column-major.
+ * @param A The matrix to write.
+ * @param path Path of the output file.
+ * @param real If true the entries are stored as FLOAT64 and their imaginary parts dropped.
+ */
+void writeBinaryMatrix(Eigen::MatrixXcd const& A, std::string const& path, bool real);
+
+#endif //BINARYMATRIX_H
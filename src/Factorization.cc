@@ -0,0 +1,275 @@
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "Factorization.h"
+#include "utils.h"
+
+/** @file Factorization.cc
+ * @brief Implementation file for the matrix factorizations.
+ */
+
+/// Reciprocal condition number below which a matrix is treated as singular
+static const double SINGULAR_RCOND = std::numeric_limits<double>::epsilon();
+
+/**
+ * @brief LU factorization with partial pivoting.
+ * @param M The matrix to factorize.
+ * @return False if the matrix is numerically singular.
+ */
+bool LUFactorization::compute(Eigen::MatrixXcd const& M)
+{
+    lu.compute(M);
+    return lu.rcond() > SINGULAR_RCOND;
+}
+
+/// Solve with the LU factors
+Eigen::MatrixXcd LUFactorization::solve(Eigen::MatrixXcd const& B) const
+{
+    return lu.solve(B);
+}
+
+/// Solve with the LU factors into an existing vector
+void LUFactorization::solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const
+{
+    x = lu.solve(b);
+}
+
+/// Name of the LU factorization
+std::string LUFactorization::getName() const
+{
+    return "LU";
+}
+
+/**
+ * @brief LDLT factorization of a Hermitian matrix.
+ * @param M The matrix to factorize, only the lower triangle is used.
+ * @return False if the factorization failed or the matrix is numerically singular.
+ */
+bool LDLTFactorization::compute(Eigen::MatrixXcd const& M)
+{
+    ldlt.compute(M);
+    if (ldlt.info() != Eigen::Success) {
+        return false;
+    }
+    // Zero pivots are pseudo-inverted by the solve, so the rcond estimate misses them
+    Eigen::VectorXd pivots = ldlt.vectorD().cwiseAbs();
+    return pivots.minCoeff() > SINGULAR_RCOND*pivots.maxCoeff() && ldlt.rcond() > SINGULAR_RCOND;
+}
+
+/// Solve with the LDLT factors
+Eigen::MatrixXcd LDLTFactorization::solve(Eigen::MatrixXcd const& B) const
+{
+    return ldlt.solve(B);
+}
+
+/// Solve with the LDLT factors into an existing vector
+void LDLTFactorization::solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const
+{
+    x = ldlt.solve(b);
+}
+
+/// Name of the LDLT factorization
+std::string LDLTFactorization::getName() const
+{
+    return "LDLT";
+}
+
+/**
+ * @brief Cholesky factorization of a Hermitian positive definite matrix.
+ * @param M The matrix to factorize, only the lower triangle is used.
+ * @return False if the matrix is not positive definite or numerically singular.
+ */
+bool LLTFactorization::compute(Eigen::MatrixXcd const& M)
+{
+    llt.compute(M);
+    return llt.info() == Eigen::Success && llt.rcond() > SINGULAR_RCOND;
+}
+
+/// Solve with the Cholesky factor
+Eigen::MatrixXcd LLTFactorization::solve(Eigen::MatrixXcd const& B) const
+{
+    return llt.solve(B);
+}
+
+/// Solve with the Cholesky factor into an existing vector
+void LLTFactorization::solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const
+{
+    x = llt.solve(b);
+}
+
+/// Name of the Cholesky factorization
+std::string LLTFactorization::getName() const
+{
+    return "LLT";
+}
+
+/**
+ * @brief Complete orthogonal decomposition.
+ * @param M The matrix to factorize.
+ * @return Always true, singular matrices are handled through the rank.
+ */
+bool CODFactorization::compute(Eigen::MatrixXcd const& M)
+{
+    cod.compute(M);
+    return true;
+}
+
+/// Minimum norm least squares solve with the complete orthogonal decomposition
+Eigen::MatrixXcd CODFactorization::solve(Eigen::MatrixXcd const& B) const
+{
+    return cod.solve(B);
+}
+
+/// Solve with the complete orthogonal decomposition into an existing vector
+void CODFactorization::solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const
+{
+    x = cod.solve(b);
+}
+
+/// Name of the complete orthogonal decomposition
+std::string CODFactorization::getName() const
+{
+    return "COD";
+}
+
+/**
+ * @brief Hessenberg reduction followed by the factorization without shift.
+ * @param M The matrix to factorize.
+ * @return False if the matrix is singular.
+ */
+bool HessenbergFactorization::compute(Eigen::MatrixXcd const& M)
+{
+    Eigen::HessenbergDecomposition<Eigen::MatrixXcd> hessenberg(M);
+    Q = hessenberg.matrixQ();
+    H = hessenberg.matrixH();
+    return setShift(0);
+}
+
+/**
+ * @brief LU factorization with partial pivoting of the shifted Hessenberg matrix.
+ * 
+ * Every column has a single entry below the diagonal, so the pivot is chosen between two
+ * rows and eliminating it updates a single row: @f$ O(n^2) @f$ operations in total.
+ * Pivots are not compared with the machine precision: Rayleigh quotient iteration
+ * drives the shift to an eigenvalue on purpose, and a tiny pivot only scales the
+ * solution in the direction of the wanted eigenvector.
+ * @param shift The shift @f$ \sigma @f$.
+ * @return False if a pivot is exactly zero.
+ */
+bool HessenbergFactorization::setShift(Eigen::dcomplex shift)
+{
+    int n = H.rows();
+    U = H;
+    U.diagonal().array() -= shift;
+    multipliers.setZero(n);
+    swapped.assign(n, false);
+    for (int k=0; k<n-1; k++) {
+        if (std::abs(U(k+1, k)) > std::abs(U(k, k))) {
+            U.row(k).tail(n - k).swap(U.row(k+1).tail(n - k));
+            swapped[k] = true;
+        }
+        if (U(k, k) != 0.0) {
+            multipliers(k) = U(k+1, k) / U(k, k);
+            U.row(k+1).tail(n - k) -= multipliers(k) * U.row(k).tail(n - k);
+        }
+    }
+    return (U.diagonal().array() != 0.0).all();
+}
+
+/// Solve with the Hessenberg reduction and the factors of the shifted Hessenberg matrix
+Eigen::MatrixXcd HessenbergFactorization::solve(Eigen::MatrixXcd const& B) const
+{
+    Eigen::MatrixXcd X(B.rows(), B.cols());
+    Eigen::VectorXcd x;
+    for (int j=0; j<B.cols(); j++) {
+        solveInto(B.col(j), x);
+        X.col(j) = x;
+    }
+    return X;
+}
+
+/// Solve @f$ x = Q U^{-1} L^{-1} Q^H b @f$ into an existing vector
+void HessenbergFactorization::solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const
+{
+    int n = H.rows();
+    work.noalias() = Q.adjoint() * b;
+    for (int k=0; k<n-1; k++) {
+        if (swapped[k]) {
+            std::swap(work(k), work(k+1));
+        }
+        work(k+1) -= multipliers(k) * work(k);
+    }
+    U.triangularView<Eigen::Upper>().solveInPlace(work);
+    x.noalias() = Q * work;
+}
+
+/// Name of the Hessenberg factorization
+std::string HessenbergFactorization::getName() const
+{
+    return "Hessenberg LU";
+}
+
+/**
+ * @brief Factorize a matrix with the requested strategy.
+ * 
+ * "AUTO" uses LLT, then LDLT, for Hermitian matrices and LU otherwise. An explicit
+ * "LLT" falls back to LDLT for indefinite matrices. Whenever the chosen factorization
+ * fails or detects a numerically singular matrix, the complete orthogonal decomposition
+ * is used instead.
+ * @param M The matrix to factorize.
+ * @param type 'std::string' one of "AUTO", "LU", "LDLT", "LLT" or "COD".
+ * @return Pointer to the computed factorization.
+ */
+std::unique_ptr<Factorization> createFactorization(Eigen::MatrixXcd const& M, std::string const& type)
+{
+    std::vector<std::string> candidates;
+    if (type == "AUTO") {
+        if (isHermitian(M)) {
+            candidates = {"LLT", "LDLT"};
+        }
+        else {
+            candidates = {"LU"};
+        }
+    }
+    else if (type == "LU" || type == "LDLT" || type == "LLT" || type == "COD") {
+        if ((type == "LDLT" || type == "LLT") && !isHermitian(M)) {
+            std::cerr << "WARNING: " << type << " needs a Hermitian matrix. Using LU instead." << std::endl << std::flush;
+            candidates = {"LU"};
+        }
+        else if (type == "LLT") {
+            candidates = {"LLT", "LDLT"};
+        }
+        else {
+            candidates = {type};
+        }
+    }
+    else {
+        std::cerr << "WARNING: Unsupported factorization. Defaulting to AUTO." << std::endl << std::flush;
+        return createFactorization(M, "AUTO");
+    }
+
+    for (std::string const& name : candidates) {
+        std::unique_ptr<Factorization> decomp;
+        if (name == "LU") {
+            decomp = std::make_unique<LUFactorization>();
+        }
+        else if (name == "LDLT") {
+            decomp = std::make_unique<LDLTFactorization>();
+        }
+        else if (name == "LLT") {
+            decomp = std::make_unique<LLTFactorization>();
+        }
+        else {
+            decomp = std::make_unique<CODFactorization>();
+        }
+        if (decomp->compute(M)) {
+            return decomp;
+        }
+    }
+
+    // Near-singular matrix, fall back to the rank revealing decomposition
+    std::cerr << "WARNING: Shifted matrix is numerically singular. Using complete orthogonal decomposition." << std::endl << std::flush;
+    std::unique_ptr<Factorization> decomp = std::make_unique<CODFactorization>();
+    decomp->compute(M);
+    return decomp;
+}
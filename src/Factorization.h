@@ -0,0 +1,157 @@
+#ifndef FACTORIZATION_H
+#define FACTORIZATION_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <Eigen/Dense>
+
+/** @file Factorization.h
+ * @brief Header file for the matrix factorizations used by inverse iterations.
+ */
+
+/**
+ * @class Factorization
+ * @brief Abstract factorization of a square matrix, used to solve linear systems.
+ */
+class Factorization
+{
+    public:
+        /// Abstract destructor
+        virtual ~Factorization() {};
+        /**
+         * @brief Factorizes a matrix.
+         * @param M The matrix to factorize.
+         * @return False if the factorization failed or the matrix is numerically singular.
+         */
+        virtual bool compute(Eigen::MatrixXcd const& M) = 0;
+        /**
+         * @brief Solves @f$ M X = B @f$ with the factorized matrix.
+         * @param B Right-hand side, one system per column.
+         * @return 'Eigen::MatrixXcd' containing the solution X.
+         */
+        virtual Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const = 0;
+        /**
+         * @brief Solves @f$ M x = b @f$ into an existing vector.
+         *
+         * A solution vector of the right size is overwritten in place, so repeated solves
+         * do not allocate (except for the complete orthogonal decomposition).
+         * @param b Right-hand side.
+         * @param x Solution, resized only if needed.
+         */
+        virtual void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const = 0;
+        /**
+         * @brief Name of the factorization.
+         * @return 'std::string' with a short name, e.g. "LU".
+         */
+        virtual std::string getName() const = 0;
+};
+
+/**
+ * @class LUFactorization
+ * @brief LU decomposition with partial pivoting, for general matrices.
+ */
+class LUFactorization : public Factorization
+{
+    protected:
+        Eigen::PartialPivLU<Eigen::MatrixXcd> lu; /// Eigen decomposition
+    public:
+        bool compute(Eigen::MatrixXcd const& M) override;
+        Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const override;
+        void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const override;
+        std::string getName() const override;
+};
+
+/**
+ * @class LDLTFactorization
+ * @brief Robust Cholesky decomposition with pivoting @f$ P^T L D L^H P @f$, for Hermitian matrices.
+ */
+class LDLTFactorization : public Factorization
+{
+    protected:
+        Eigen::LDLT<Eigen::MatrixXcd> ldlt; /// Eigen decomposition
+    public:
+        bool compute(Eigen::MatrixXcd const& M) override;
+        Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const override;
+        void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const override;
+        std::string getName() const override;
+};
+
+/**
+ * @class LLTFactorization
+ * @brief Cholesky decomposition @f$ L L^H @f$, for Hermitian positive definite matrices.
+ */
+class LLTFactorization : public Factorization
+{
+    protected:
+        Eigen::LLT<Eigen::MatrixXcd> llt; /// Eigen decomposition
+    public:
+        bool compute(Eigen::MatrixXcd const& M) override;
+        Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const override;
+        void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const override;
+        std::string getName() const override;
+};
+
+/**
+ * @class CODFactorization
+ * @brief Complete orthogonal decomposition, rank revealing and safe for singular matrices.
+ */
+class CODFactorization : public Factorization
+{
+    protected:
+        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXcd> cod; /// Eigen decomposition
+    public:
+        bool compute(Eigen::MatrixXcd const& M) override;
+        Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const override;
+        void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const override;
+        std::string getName() const override;
+};
+
+/**
+ * @class HessenbergFactorization
+ * @brief Hessenberg reduction @f$ M = Q H Q^H @f$ computed once, then refactorized cheaply for any shift.
+ *
+ * After the @f$ O(n^3) @f$ reduction, the LU decomposition with partial pivoting of
+ * @f$ H - \sigma I @f$ only eliminates the subdiagonal and costs @f$ O(n^2) @f$, as does
+ * every solve, so the shift can change at every step of Rayleigh quotient iteration.
+ */
+class HessenbergFactorization : public Factorization
+{
+    protected:
+        Eigen::MatrixXcd Q; /// Unitary factor of the reduction
+        Eigen::MatrixXcd H; /// Upper Hessenberg form of the matrix
+        Eigen::MatrixXcd U; /// Upper triangular factor of @f$ H - \sigma I @f$
+        Eigen::VectorXcd multipliers; /// Multiplier eliminating the subdiagonal entry of every column
+        std::vector<bool> swapped; /// True if rows k and k+1 were swapped to eliminate column k
+        mutable Eigen::VectorXcd work; /// Workspace of the solves
+    public:
+        /**
+         * @brief Reduces a matrix to Hessenberg form and factorizes it without shift.
+         * @param M The matrix to factorize.
+         * @return False if the matrix is singular.
+         */
+        bool compute(Eigen::MatrixXcd const& M) override;
+        /**
+         * @brief Factorizes @f$ M - \sigma I @f$ from the Hessenberg form, in @f$ O(n^2) @f$.
+         * @param shift The shift @f$ \sigma @f$.
+         * @return False if a pivot is exactly zero.
+         */
+        bool setShift(Eigen::dcomplex shift);
+        Eigen::MatrixXcd solve(Eigen::MatrixXcd const& B) const override;
+        void solveInto(Eigen::VectorXcd const& b, Eigen::VectorXcd & x) const override;
+        std::string getName() const override;
+};
+
+/**
+ * @brief Factorize a matrix with the requested strategy.
+ *
+ * "AUTO" uses LLT, then LDLT, for Hermitian matrices and LU otherwise. Whenever the
+ * chosen factorization fails or detects a numerically singular matrix, the complete
+ * orthogonal decomposition is used instead.
+ * @param M The matrix to factorize.
+ * @param type 'std::string' one of "AUTO", "LU", "LDLT", "LLT" or "COD".
+ * @return Pointer to the computed factorization.
+ */
+std::unique_ptr<Factorization> createFactorization(Eigen::MatrixXcd const& M, std::string const& type);
+
+#endif //FACTORIZATION_H
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <exprtk/exprtk.hpp>
+#include "FunctionOperator.h"
+#include "Exceptions.h"
+
+/** @file FunctionOperator.cc
+ * @brief Implementation file for the matrix-free operator defined by an expression.
+ */
+
+/// Rows per tile of a product, the tile of the output stays in cache over all the columns
+static constexpr long ROW_TILE = 256;
+/// Columns per block when building the dense matrix
+static constexpr long COL_BLOCK = 64;
+
+/**
+ * @struct FunctionOperator::Evaluator
+ * @brief Compiled expression of a worker, bound to its own row and column variables.
+ */
+struct FunctionOperator::Evaluator
+{
+    double i = 1; /// Row variable, starting at 1
+    double j = 1; /// Column variable, starting at 1
+    exprtk::symbol_table<double> symbol_table; /// Symbol table holding i and j
+    exprtk::expression<double> expression; /// Compiled expression
+};
+
+/**
+ * @brief FunctionOperator constructor
+ *
+ * Starts the workers and compiles one copy of the expression for each of them.
+ * @param func Expression defining the entries, with row i and column j starting at 1.
+ * @param size Number of rows and columns.
+ * @param num_threads Number of workers, 0 uses all hardware threads.
+ * @param symmetric If true the upper triangle is mirrored.
+ */
+FunctionOperator::FunctionOperator(std::string const& func, int size, int num_threads, bool symmetric)
+    : func(func), n(size), symmetric(symmetric), pool(num_threads), evaluated_entries(0), product_time(0), num_products(0)
+{
+    if (n <= 0) {
+        throw ReaderError("Error: size must be non-negative.");
+    }
+    exprtk::parser<double> parser;
+    for (int t=0; t<pool.size(); t++) {
+        auto evaluator = std::make_unique<Evaluator>();
+        evaluator->symbol_table.add_variable("i", evaluator->i);
+        evaluator->symbol_table.add_variable("j", evaluator->j);
+        evaluator->expression.register_symbol_table(evaluator->symbol_table);
+        if (!parser.compile(func, evaluator->expression)) {
+            throw ReaderError("Invalid matrix generating function: " + parser.error());
+        }
+        evaluators.push_back(std::move(evaluator));
+    }
+}
+
+/// Joins the workers before the evaluators are released
+FunctionOperator::~FunctionOperator() {}
+
+/// Number of rows (and columns) of the operator
+int FunctionOperator::size() const
+{
+    return n;
+}
+
+/**
+ * @brief Evaluates the entry in a row and a column, mirrored with the symmetry hint.
+ * @param e Evaluator of the calling worker.
+ * @param row Row, starting at 0.
+ * @param col Column, starting at 0.
+ * @return The entry.
+ */
+double FunctionOperator::entry(Evaluator * e, long row, long col) const
+{
+    if (symmetric && row > col) {
+        std::swap(row, col);
+    }
+    e->i = row + 1;
+    e->j = col + 1;
+    return e->expression.value();
+}
+
+/**
+ * @brief Computes @f$ Y = A X @f$, evaluating every entry once.
+ *
+ * Tiles of rows are handed out dynamically to the workers. A worker evaluates its tile
+ * column by column and accumulates into a local tile of Y, which is copied out at the
+ * end, so every entry is evaluated once whatever the number of vectors in X.
+ * @param X Input block, one vector per column.
+ * @param Y Output block.
+ */
+void FunctionOperator::multiply(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    long num_tiles = (n + ROW_TILE - 1) / ROW_TILE;
+    std::atomic<long> next_tile(0);
+    long k = X.cols();
+
+    for (auto const& evaluator : evaluators) {
+        Evaluator * e = evaluator.get();
+        pool.submit([&, e]() {
+            Eigen::MatrixXcd Y_tile(ROW_TILE, k);
+            long tile;
+            while ((tile = next_tile++) < num_tiles) {
+                long first = tile * ROW_TILE;
+                long rows = std::min<long>(ROW_TILE, n - first);
+                Y_tile.setZero();
+                for (long col = 0; col < n; col++) {
+                    if (k == 1) {
+                        Eigen::dcomplex x = X(col, 0);
+                        for (long row = 0; row < rows; row++) {
+                            Y_tile(row, 0) += entry(e, first + row, col) * x;
+                        }
+                    }
+                    else {
+                        for (long row = 0; row < rows; row++) {
+                            Y_tile.row(row) += entry(e, first + row, col) * X.row(col);
+                        }
+                    }
+                }
+                Y.middleRows(first, rows) = Y_tile.topRows(rows);
+            }
+        });
+    }
+    pool.wait();
+
+    evaluated_entries += static_cast<long long>(n) * n;
+    num_products++;
+    product_time += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+/**
+ * @brief Applies the operator to a vector, evaluating the entries on the fly.
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x @f$.
+ */
+void FunctionOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    multiply(Eigen::Map<const Eigen::MatrixXcd>(x.data(), n, 1), Eigen::Map<Eigen::MatrixXcd>(y.data(), n, 1));
+}
+
+/**
+ * @brief Applies the operator to a block of vectors, evaluating every entry only once.
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X @f$.
+ */
+void FunctionOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    multiply(X, Y);
+}
+
+/**
+ * @brief Builds the dense matrix, evaluating every entry once on the workers.
+ * @return 'Eigen::MatrixXcd' containing the operator.
+ */
+Eigen::MatrixXcd FunctionOperator::toDense() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Eigen::MatrixXcd M(n, n);
+    long num_blocks = (n + COL_BLOCK - 1) / COL_BLOCK;
+    std::atomic<long> next_block(0);
+    for (auto const& evaluator : evaluators) {
+        Evaluator * e = evaluator.get();
+        pool.submit([&, e]() {
+            long b;
+            while ((b = next_block++) < num_blocks) {
+                for (long col = b * COL_BLOCK; col < std::min<long>(n, (b + 1) * COL_BLOCK); col++) {
+                    for (long row = 0; row < n; row++) {
+                        M(row, col) = entry(e, row, col);
+                    }
+                }
+            }
+        });
+    }
+    pool.wait();
+    return M;
+}
+
+/**
+ * @brief Adds the number of products and the matvec throughput to a solver's output.
+ * @param metrics (name, value) pairs to append to.
+ */
+void FunctionOperator::reportMetrics(std::vector<std::pair<std::string, std::string>> & metrics) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    metrics.emplace_back("Matrix-Vector Products", std::to_string(num_products));
+    metrics.emplace_back("Evaluated Entries", std::to_string(evaluated_entries));
+    metrics.emplace_back("Matvec Throughput", std::to_string(product_time > 0 ? static_cast<double>(evaluated_entries) / product_time : 0.0) + " entries/s");
+    metrics.emplace_back("Evaluation Threads", std::to_string(evaluators.size()));
+}
@@ -0,0 +1,74 @@
+#ifndef FUNCTIONOPERATOR_H
+#define FUNCTIONOPERATOR_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include "LinearOperator.h"
+#include "ThreadPool.h"
+
+/** @file FunctionOperator.h
+ * @brief Header file for the matrix-free operator defined by an expression.
+ */
+
+/**
+ * @class FunctionOperator
+ * @brief Operator with entries @f$ a_{ij} = f(i, j) @f$, evaluated during every product.
+ *
+ * With the symmetry hint the entries are @f$ f(\min(i, j), \max(i, j)) @f$, the upper
+ * triangle mirrored, as for the dense matrix generated by FunctionReader.
+ * The matrix is never stored, so memory use is O(n). Products are computed in tiles of
+ * rows and columns on a thread pool; every worker owns a compiled copy of the
+ * expression and the rows of its tiles, so no synchronization is needed inside a
+ * product. Products are serialized, as the workers and their expressions are shared.
+ */
+class FunctionOperator : public LinearOperator
+{
+    protected:
+        /// Compiled expression and its variables, one per worker
+        struct Evaluator;
+        std::string func; /// Expression defining the entries, with row i and column j starting at 1
+        int n; /// Number of rows and columns
+        bool symmetric; /// Whether the upper triangle is mirrored
+        std::vector<std::unique_ptr<Evaluator>> evaluators; /// One evaluator per worker
+        mutable ThreadPool pool; /// Workers computing the tiles
+        mutable std::mutex mutex; /// Serializes the products
+        mutable long long evaluated_entries; /// Number of entries evaluated in products
+        mutable double product_time; /// Time spent in products, in seconds
+        mutable long num_products; /// Number of products, a block product counts once
+        /**
+         * @brief Computes @f$ Y = A X @f$, evaluating every entry once.
+         * @param X Input block, one vector per column.
+         * @param Y Output block.
+         */
+        void multiply(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const;
+        /**
+         * @brief Evaluates the entry in a row and a column, mirrored with the symmetry hint.
+         * @param e Evaluator of the calling worker.
+         * @param row Row, starting at 0.
+         * @param col Column, starting at 0.
+         * @return The entry.
+         */
+        double entry(Evaluator * e, long row, long col) const;
+    public:
+        /**
+         * @brief FunctionOperator constructor
+         * @param func Expression defining the entries, with row i and column j starting at 1.
+         * @param size Number of rows and columns.
+         * @param num_threads Number of workers, 0 uses all hardware threads.
+         * @param symmetric If true the upper triangle is mirrored.
+         * @throws ReaderError if the expression does not compile.
+         */
+        FunctionOperator(std::string const& func, int size, int num_threads, bool symmetric = false);
+        /// FunctionOperator destructor
+        ~FunctionOperator();
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override;
+        Eigen::MatrixXcd toDense() const override;
+        void reportMetrics(std::vector<std::pair<std::string, std::string>> & metrics) const override;
+};
+
+#endif //FUNCTIONOPERATOR_H
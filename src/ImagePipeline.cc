@@ -0,0 +1,327 @@
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include "ImagePipeline.h"
+#include "Exceptions.h"
+#include "Reader.h"
+#include "utils.h"
+
+/** @file ImagePipeline.cc
+ * @brief Implementation file for solving a set of images with decoding and solving overlapped.
+ */
+
+/// File extensions of the images taken from a directory
+static const std::vector<std::string> IMAGE_EXTENSIONS = {".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".pgm", ".ppm", ".psd", ".hdr"};
+
+/**
+ * @brief Matches a file name against a pattern with '*' and '?' wildcards.
+ * @param pattern The pattern.
+ * @param name The file name.
+ * @return True if the whole name matches.
+ */
+static bool matchPattern(const char * pattern, const char * name)
+{
+    if (*pattern == '\0') {
+        return *name == '\0';
+    }
+    if (*pattern == '*') {
+        return matchPattern(pattern + 1, name) || (*name != '\0' && matchPattern(pattern, name + 1));
+    }
+    return *name != '\0' && (*pattern == '?' || *pattern == *name) && matchPattern(pattern + 1, name + 1);
+}
+
+/// Seconds elapsed since a time point
+static double secondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * @brief Checks whether a picture path names a set of images.
+ * @param path Picture path of a configuration.
+ * @return True if the path is a directory or its file name contains a '*' or '?' wildcard.
+ */
+bool isPictureSet(std::string const& path)
+{
+    std::string name = std::filesystem::path(path).filename().string();
+    return std::filesystem::is_directory(path) || name.find_first_of("*?") != std::string::npos;
+}
+
+/**
+ * @brief ImagePipeline constructor, collects the images and the settings of the stages.
+ *
+ * A directory contributes all of its images in alphabetical order, a pattern the files
+ * of its directory whose name matches. DECODERS defaults to 1, SOLVERS to the remaining
+ * hardware threads and QUEUE_DEPTH to one buffer per thread.
+ * @param config_path Configuration with a PICTURE input whose path is a directory or pattern.
+ */
+ImagePipeline::ImagePipeline(std::filesystem::path const& config_path)
+{
+    json data = readConfig(config_path);
+    settings = readRunConfig(data);
+    if (data["INPUT"] != "PICTURE") {
+        throw ConfigError("ERROR: The image pipeline needs a PICTURE input.");
+    }
+    std::string picture_path;
+    picture_path = getJsonValueNecessary<std::string, ConfigError>(data["PICTURE"], "PATH",
+        "ERROR: Missing picture path.");
+    if (!isPictureSet(picture_path)) {
+        throw ConfigError("ERROR: Picture path is not a directory or pattern.");
+    }
+
+    // Size of the matrices, number of threads of every stage and of buffers, silently the defaults if missing
+    target_size = data["PICTURE"].value("TARGET_SIZE", 0);
+    num_decoders = data["PICTURE"].value("DECODERS", 1);
+    num_solvers = data["PICTURE"].value("SOLVERS", 0);
+    queue_depth = data["PICTURE"].value("QUEUE_DEPTH", 0);
+    if (data["PICTURE"].value("LEVELS", 1) > 1) {
+        std::cerr << "WARNING: Multi-resolution levels are not supported by the image pipeline. Solving the finest level only." << std::endl << std::flush;
+    }
+    if (num_decoders < 1) {
+        std::cerr << "WARNING: Invalid number of decoders. Defaulting to 1." << std::endl << std::flush;
+        num_decoders = 1;
+    }
+    if (num_solvers <= 0) {
+        num_solvers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - num_decoders);
+    }
+    if (queue_depth <= 0) {
+        queue_depth = num_decoders + num_solvers;
+    }
+
+    std::filesystem::path path = picture_path;
+    if (std::filesystem::is_directory(path)) {
+        for (auto const& entry : std::filesystem::directory_iterator(path)) {
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+            if (entry.is_regular_file() && std::find(IMAGE_EXTENSIONS.begin(), IMAGE_EXTENSIONS.end(), extension) != IMAGE_EXTENSIONS.end()) {
+                frames.push_back(entry.path());
+            }
+        }
+    }
+    else {
+        std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+        std::string pattern = path.filename().string();
+        if (std::filesystem::is_directory(directory)) {
+            for (auto const& entry : std::filesystem::directory_iterator(directory)) {
+                if (entry.is_regular_file() && matchPattern(pattern.c_str(), entry.path().filename().string().c_str())) {
+                    frames.push_back(entry.path());
+                }
+            }
+        }
+    }
+    if (frames.empty()) {
+        throw ConfigError("ERROR: Picture set does not contain any image.");
+    }
+    std::sort(frames.begin(), frames.end());
+}
+
+/**
+ * @brief Main loop of a decoder thread.
+ *
+ * Claims the next image, waits for a free buffer, decodes into it and queues it. An
+ * image that cannot be decoded is recorded as failed and its buffer returned.
+ * @param next_frame Index of the next image to decode, shared by the decoders.
+ */
+void ImagePipeline::decodeLoop(std::atomic<int> & next_frame)
+{
+    int frame;
+    while ((frame = next_frame++) < static_cast<int>(frames.size())) {
+        int buffer;
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            buffer_freed.wait(lock, [this]() { return !free_buffers.empty(); });
+            buffer = free_buffers.back();
+            free_buffers.pop_back();
+            decoder_stall_time += secondsSince(wait_start);
+        }
+
+        // The buffer belongs to this decoder until it is queued
+        auto decode_start = std::chrono::high_resolution_clock::now();
+        Eigen::Index old_size = buffers[buffer].size();
+        bool decoded = true;
+        try {
+            loadPicture(frames[frame].string(), target_size, buffers[buffer]);
+        }
+        catch (const ReaderError &e) {
+            results[frame].error = std::string("Reader error: ") + e.what();
+            decoded = false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decode_time += secondsSince(decode_start);
+            if (decoded) {
+                reallocations += (buffers[buffer].size() != old_size);
+                ready.push_back({frame, buffer});
+            }
+            else {
+                free_buffers.push_back(buffer);
+            }
+        }
+        if (decoded) {
+            frame_ready.notify_one();
+        }
+        else {
+            buffer_freed.notify_one();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decoders_running--;
+    }
+    frame_ready.notify_all();
+}
+
+/**
+ * @brief Main loop of a solver thread.
+ *
+ * Takes the oldest decoded image and moves its buffer into the input of a solver, so
+ * the image is not copied. The solver gives the buffer back once it has finished, and
+ * it is then returned to the decoders. Ends when the queue is empty and all the
+ * decoders have finished. Errors are recorded in the result of the image.
+ */
+void ImagePipeline::solveLoop()
+{
+    while (true) {
+        DecodedFrame item;
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frame_ready.wait(lock, [this]() { return !ready.empty() || decoders_running == 0; });
+            solver_idle_time += secondsSince(wait_start);
+            if (ready.empty()) {
+                return;
+            }
+            item = ready.front();
+            ready.pop_front();
+        }
+
+        auto solve_start = std::chrono::high_resolution_clock::now();
+        InputData input = settings;
+        input.input_matrix = std::move(buffers[item.buffer]);
+        input.size = input.input_matrix.rows();
+
+        BatchResult & result = results[item.frame];
+        std::unique_ptr<Solver> solver;
+        try {
+            solver.reset(createSolver(std::move(input)));
+            solver->solve();
+            result.output = solver->getOutput();
+            result.success = true;
+        }
+        catch (const ConfigError &e) {
+            result.error = std::string("Configuration File error: ") + e.what();
+        }
+        catch (const std::exception &e) {
+            result.error = e.what();
+        }
+        // A solver that consumed its matrix gives back an empty buffer, which the decoder reallocates
+        if (solver) {
+            buffers[item.buffer] = solver->releaseMatrix();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            solve_time += secondsSince(solve_start);
+            free_buffers.push_back(item.buffer);
+        }
+        buffer_freed.notify_one();
+    }
+}
+
+/**
+ * @brief Decodes and solves every image.
+ *
+ * Starts the decoder and solver threads and waits for them, then computes the
+ * utilization of every stage: the fraction of the wall time its threads spent working.
+ */
+void ImagePipeline::run()
+{
+    buffers.assign(queue_depth, Eigen::MatrixXcd());
+    free_buffers.clear();
+    for (int b=queue_depth-1; b>=0; b--) {
+        free_buffers.push_back(b);
+    }
+    ready.clear();
+    results.assign(frames.size(), BatchResult());
+    for (std::size_t f=0; f<frames.size(); f++) {
+        results[f].config = frames[f];
+        results[f].success = false;
+    }
+    decoders_running = num_decoders;
+    decode_time = decoder_stall_time = solve_time = solver_idle_time = 0;
+    reallocations = 0;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::atomic<int> next_frame(0);
+    std::vector<std::thread> threads;
+    for (int d=0; d<num_decoders; d++) {
+        threads.emplace_back(&ImagePipeline::decodeLoop, this, std::ref(next_frame));
+    }
+    for (int s=0; s<num_solvers; s++) {
+        threads.emplace_back(&ImagePipeline::solveLoop, this);
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    double wall_time = secondsSince(start_time);
+
+    auto percent = [wall_time](double busy, int threads) {
+        return std::to_string(wall_time > 0 ? 100.0 * busy / (threads * wall_time) : 0.0) + " %";
+    };
+    metrics.clear();
+    metrics.emplace_back("Images", std::to_string(frames.size()));
+    metrics.emplace_back("Pipeline Time", std::to_string(wall_time) + " seconds");
+    metrics.emplace_back("Throughput", std::to_string(wall_time > 0 ? frames.size() / wall_time : 0.0) + " images/s");
+    metrics.emplace_back("Decoders", std::to_string(num_decoders) + ", " + std::to_string(queue_depth) + " buffers");
+    metrics.emplace_back("Decode Utilization", percent(decode_time, num_decoders));
+    metrics.emplace_back("Decoder Stall", percent(decoder_stall_time, num_decoders));
+    metrics.emplace_back("Solvers", std::to_string(num_solvers));
+    metrics.emplace_back("Solve Utilization", percent(solve_time, num_solvers));
+    metrics.emplace_back("Solver Idle", percent(solver_idle_time, num_solvers));
+    metrics.emplace_back("Buffer Allocations", std::to_string(reallocations));
+
+    std::cout << "Pipeline finished: " << frames.size() - numFailed() << " of " << frames.size()
+        << " images succeeded." << std::endl;
+    for (auto const& metric : metrics) {
+        std::cout << metric.first << ": " << metric.second << std::endl;
+    }
+}
+
+/**
+ * @brief Method to get the results of the pipeline
+ * @return Vector with one BatchResult per image, whose config is the image path
+ */
+std::vector<BatchResult> ImagePipeline::getResults() const
+{
+    return results;
+}
+
+/**
+ * @brief Number of failed images.
+ * @return Number of images that could not be decoded or solved.
+ */
+int ImagePipeline::numFailed() const
+{
+    return std::count_if(results.begin(), results.end(), [](BatchResult const& r) { return !r.success; });
+}
+
+/**
+ * @brief Method to get the metrics of the last run
+ * @return (name, value) pairs with the throughput and the utilization of every stage
+ */
+std::vector<std::pair<std::string, std::string>> ImagePipeline::getMetrics() const
+{
+    return metrics;
+}
+
+/**
+ * @brief Writes the results of all images to a single CSV file, in the batch format.
+ * @param out_path std::string containing the output file path
+ */
+void ImagePipeline::saveOutput(std::string const& out_path) const
+{
+    saveBatchResults(results, out_path);
+}
@@ -0,0 +1,105 @@
+#ifndef IMAGEPIPELINE_H
+#define IMAGEPIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+#include "InputData.h"
+#include "BatchRunner.h"
+
+/** @file ImagePipeline.h
+ * @brief Header file for solving a set of images with decoding and solving overlapped.
+ */
+
+/**
+ * @brief Checks whether a picture path names a set of images.
+ * @param path Picture path of a configuration.
+ * @return True if the path is a directory or its file name contains a '*' or '?' wildcard.
+ */
+bool isPictureSet(std::string const& path);
+
+/**
+ * @class ImagePipeline
+ * @brief Solves every image of a directory or pattern, decoding the next images while solving.
+ *
+ * Decoder threads decode the images into a fixed pool of matrix buffers and queue
+ * them; solver threads move the queued buffers into their solver and return them to
+ * the pool once the solve has finished. The pool bounds the number of decoded images
+ * in memory, so decoders stall instead of using memory when solvers fall behind, and
+ * buffers are only reallocated when the image size changes or a solver consumed them.
+ */
+class ImagePipeline
+{
+protected:
+    /// Image decoded into a buffer, waiting for a solver
+    struct DecodedFrame {
+        int frame; /// Index of the image
+        int buffer; /// Index of the buffer holding it
+    };
+    std::vector<std::filesystem::path> frames; /// Images, one job each, sorted
+    InputData settings; /// Solver settings shared by all images, without matrix
+    int target_size; /// Side of the matrices, 0 keeps the smaller side of every image
+    int num_decoders; /// Number of decoder threads
+    int num_solvers; /// Number of solver threads
+    int queue_depth; /// Number of matrix buffers, the bound on decoded images waiting or being solved
+    std::vector<Eigen::MatrixXcd> buffers; /// Pool of matrix buffers
+    std::vector<int> free_buffers; /// Buffers available to the decoders
+    std::deque<DecodedFrame> ready; /// Decoded images waiting for a solver, in decoding order
+    int decoders_running; /// Decoders that have not finished yet
+    std::mutex mutex; /// Protects the buffers lists, the queue and the counters
+    std::condition_variable buffer_freed; /// Wakes decoders waiting for a buffer
+    std::condition_variable frame_ready; /// Wakes solvers waiting for an image
+    std::vector<BatchResult> results; /// Results, in the order of the images
+    double decode_time; /// Time spent decoding, summed over the decoders, in seconds
+    double decoder_stall_time; /// Time decoders waited for a free buffer, in seconds
+    double solve_time; /// Time spent solving, summed over the solvers, in seconds
+    double solver_idle_time; /// Time solvers waited for a decoded image, in seconds
+    long reallocations; /// Number of times a buffer was allocated or changed size
+    std::vector<std::pair<std::string, std::string>> metrics; /// Utilization of the stages of the last run
+    /**
+     * @brief Main loop of a decoder thread.
+     * @param next_frame Index of the next image to decode, shared by the decoders.
+     */
+    void decodeLoop(std::atomic<int> & next_frame);
+    /// Main loop of a solver thread
+    void solveLoop();
+public:
+    /**
+     * @brief ImagePipeline constructor
+     * @param config_path Configuration with a PICTURE input whose path is a directory or pattern.
+     * @throws ConfigError if the configuration is invalid or matches no image.
+     */
+    ImagePipeline(std::filesystem::path const& config_path);
+    /**
+     * @brief Decodes and solves every image.
+     */
+    void run();
+    /**
+     * @brief Method to get the results of the pipeline
+     * @return Vector with one BatchResult per image, whose config is the image path
+     */
+    std::vector<BatchResult> getResults() const;
+    /**
+     * @brief Number of failed images.
+     * @return Number of images that could not be decoded or solved.
+     */
+    int numFailed() const;
+    /**
+     * @brief Method to get the metrics of the last run
+     * @return (name, value) pairs with the throughput and the utilization of every stage
+     */
+    std::vector<std::pair<std::string, std::string>> getMetrics() const;
+    /**
+     * @brief Writes the results of all images to a single CSV file.
+     * @param out_path std::string containing the output file path
+     */
+    void saveOutput(std::string const& out_path) const;
+};
+
+#endif //IMAGEPIPELINE_H
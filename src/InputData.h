@@ -2,8 +2,12 @@
 #define INPUT_H
 
 #include <Eigen/Dense>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "LinearOperator.h"
 
 /**
  * @struct InputData
@@ -16,7 +20,23 @@ struct InputData
     int num_iters;
     double tol;
     Eigen::MatrixXcd input_matrix;
+    /// Operator for inputs that are not stored as a dense matrix (e.g. sparse), empty otherwise
+    std::shared_ptr<LinearOperator> op;
     nlohmann::json method_config;
+    /// Seed of the random number generator used by the solver
+    unsigned int seed = 0;
+    /// True if the input is known to be Hermitian, e.g. from a Matrix Market header
+    bool hermitian = false;
+    /// Downsampled copies of the input for coarse-to-fine solves, coarsest first, empty otherwise
+    std::vector<Eigen::MatrixXcd> coarse_levels;
+    /// Starting vectors for the iterative solvers, one per column, random if empty
+    Eigen::MatrixXcd initial_vectors;
+    /// Metrics measured while reading the input, e.g. the generation time, copied to the output
+    std::vector<std::pair<std::string, std::string>> metrics;
+    /// True to balance the input matrix before solving
+    bool balance = false;
+    /// Diagonal D of the balancing similarity @f$ D^{-1} A D @f$, empty if the input was not balanced
+    Eigen::VectorXd scaling;
 };
 
 #endif //INPUT_H
@@ -0,0 +1,160 @@
+#include "LinearOperator.h"
+
+/** @file LinearOperator.cc
+ * @brief Implementation file for the linear operators.
+ */
+
+/**
+ * @brief Builds the dense matrix of the operator.
+ * 
+ * Generic implementation applying the operator to every unit vector.
+ * @return 'Eigen::MatrixXcd' containing the operator.
+ */
+Eigen::MatrixXcd LinearOperator::toDense() const
+{
+    int n = size();
+    Eigen::MatrixXcd M(n, n);
+    Eigen::VectorXcd e = Eigen::VectorXcd::Zero(n);
+    for (int j = 0; j < n; j++) {
+        e(j) = 1.0;
+        apply(e, M.col(j));
+        e(j) = 0.0;
+    }
+    return M;
+}
+
+/**
+ * @brief Applies the operator to a block of vectors.
+ * 
+ * Generic implementation applying the operator column by column.
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X @f$.
+ */
+void LinearOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    for (int j = 0; j < X.cols(); j++) {
+        apply(X.col(j), Y.col(j));
+    }
+}
+
+/**
+ * @brief DenseOperator constructor
+ * @param M Dense matrix of the operator, referenced by the operator.
+ */
+DenseOperator::DenseOperator(Eigen::MatrixXcd const& M) : matrix(M) {}
+
+/// Dimension of the dense matrix
+int DenseOperator::size() const
+{
+    return matrix.rows();
+}
+
+/**
+ * @brief Dense matrix-vector product.
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x @f$.
+ */
+void DenseOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    y.noalias() = matrix * x;
+}
+
+/**
+ * @brief Dense matrix-matrix product (GEMM).
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X @f$.
+ */
+void DenseOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    Y.noalias() = matrix * X;
+}
+
+/// Copy of the dense matrix
+Eigen::MatrixXcd DenseOperator::toDense() const
+{
+    return matrix;
+}
+
+/**
+ * @brief SparseOperator constructor
+ * @param M Sparse matrix of the operator, moved into the operator.
+ */
+SparseOperator::SparseOperator(Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> M)
+    : matrix(std::move(M))
+{
+    matrix.makeCompressed();
+}
+
+/// Dimension of the sparse matrix
+int SparseOperator::size() const
+{
+    return matrix.rows();
+}
+
+/**
+ * @brief Sparse matrix-vector product in O(nnz).
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x @f$.
+ */
+void SparseOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    y.noalias() = matrix * x;
+}
+
+/**
+ * @brief Sparse times dense block product in O(nnz k).
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X @f$.
+ */
+void SparseOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    Y.noalias() = matrix * X;
+}
+
+/// Dense copy of the sparse matrix
+Eigen::MatrixXcd SparseOperator::toDense() const
+{
+    return Eigen::MatrixXcd(matrix);
+}
+
+/// Access to the underlying CSR matrix
+Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> const& SparseOperator::getMatrix() const
+{
+    return matrix;
+}
+
+/**
+ * @brief ShiftedOperator constructor
+ * @param op Unshifted operator.
+ * @param mu Shift to subtract from the diagonal.
+ */
+ShiftedOperator::ShiftedOperator(std::shared_ptr<const LinearOperator> op, Eigen::dcomplex mu)
+    : base(op), shift(mu) {}
+
+/// Dimension of the unshifted operator
+int ShiftedOperator::size() const
+{
+    return base->size();
+}
+
+/**
+ * @brief Shifted product without forming the shifted matrix.
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x - \mu x @f$.
+ */
+void ShiftedOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    base->apply(x, y);
+    y -= shift * x;
+}
+
+/**
+ * @brief Shifted block product without forming the shifted matrix.
+ * @param X Input block, one vector per column.
+ * @param Y Output block @f$ Y = A X - \mu X @f$.
+ */
+void ShiftedOperator::applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const
+{
+    base->applyBlock(X, Y);
+    Y -= shift * X;
+}
@@ -0,0 +1,127 @@
+#ifndef LINEAROPERATOR_H
+#define LINEAROPERATOR_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+/** @file LinearOperator.h
+ * @brief Header file for the linear operators used by matrix-free solvers.
+ */
+
+/**
+ * @class LinearOperator
+ * @brief Abstract square linear operator, only accessed through products with vectors.
+ */
+class LinearOperator
+{
+    public:
+        /// Abstract destructor
+        virtual ~LinearOperator() {};
+        /**
+         * @brief Dimension of the operator.
+         * @return Number of rows (and columns) of the operator.
+         */
+        virtual int size() const = 0;
+        /**
+         * @brief Applies the operator to a vector.
+         * @param x Input vector.
+         * @param y Output vector @f$ y = A x @f$, must already have the right size.
+         */
+        virtual void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const = 0;
+        /**
+         * @brief Applies the operator to a block of vectors.
+         * @param X Input block, one vector per column.
+         * @param Y Output block @f$ Y = A X @f$, must already have the right size.
+         */
+        virtual void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const;
+        /**
+         * @brief Builds the dense matrix of the operator.
+         * @return 'Eigen::MatrixXcd' with the operator applied to every unit vector.
+         */
+        virtual Eigen::MatrixXcd toDense() const;
+        /**
+         * @brief Adds operator specific metrics, such as I/O statistics, to a solver's output.
+         * @param metrics (name, value) pairs to append to. Nothing is added by default.
+         */
+        virtual void reportMetrics(std::vector<std::pair<std::string, std::string>> & /*metrics*/) const {}
+};
+
+/**
+ * @class DenseOperator
+ * @brief Operator backed by a dense matrix. The matrix is referenced, not copied.
+ */
+class DenseOperator : public LinearOperator
+{
+    protected:
+        /// Referenced matrix, must outlive the operator
+        Eigen::MatrixXcd const& matrix;
+    public:
+        /**
+         * @brief DenseOperator constructor
+         * @param M Dense matrix of the operator.
+         */
+        DenseOperator(Eigen::MatrixXcd const& M);
+        /// DenseOperator destructor
+        ~DenseOperator() {};
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override;
+        Eigen::MatrixXcd toDense() const override;
+};
+
+/**
+ * @class SparseOperator
+ * @brief Operator backed by a compressed sparse row (CSR) matrix.
+ */
+class SparseOperator : public LinearOperator
+{
+    protected:
+        /// Sparse matrix in row-major (CSR) storage
+        Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> matrix;
+    public:
+        /**
+         * @brief SparseOperator constructor
+         * @param M Sparse matrix of the operator, moved into the operator.
+         */
+        SparseOperator(Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> M);
+        /// SparseOperator destructor
+        ~SparseOperator() {};
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override;
+        Eigen::MatrixXcd toDense() const override;
+        /**
+         * @brief Access to the underlying sparse matrix.
+         * @return Const reference to the CSR matrix.
+         */
+        Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> const& getMatrix() const;
+};
+
+/**
+ * @class ShiftedOperator
+ * @brief Operator @f$ A - \mu I @f$ applied implicitly on top of another operator.
+ */
+class ShiftedOperator : public LinearOperator
+{
+    protected:
+        std::shared_ptr<const LinearOperator> base; /// Unshifted operator
+        Eigen::dcomplex shift; /// Shift @f$ \mu @f$
+    public:
+        /**
+         * @brief ShiftedOperator constructor
+         * @param op Unshifted operator.
+         * @param mu Shift to subtract from the diagonal.
+         */
+        ShiftedOperator(std::shared_ptr<const LinearOperator> op, Eigen::dcomplex mu);
+        /// ShiftedOperator destructor
+        ~ShiftedOperator() {};
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        void applyBlock(Eigen::Ref<const Eigen::MatrixXcd> X, Eigen::Ref<Eigen::MatrixXcd> Y) const override;
+};
+
+#endif //LINEAROPERATOR_H
@@ -0,0 +1,75 @@
+#include <fstream>
+#include <iterator>
+#include "MappedFile.h"
+#include "Exceptions.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** @file MappedFile.cc
+ * @brief Implementation file for read-only memory-mapped files.
+ */
+
+/**
+ * @brief Maps a file into memory.
+ *
+ * Uses mmap on POSIX systems, with a hint that the file is read sequentially. Empty
+ * files, and platforms or files that cannot be mapped, fall back to reading the file
+ * into a buffer.
+ * @param path Path of the file.
+ */
+MappedFile::MappedFile(std::string const& path) : bytes(nullptr), length(0), mapped(false)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw ReaderError("Error opening file: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void * addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, info.st_size, MADV_SEQUENTIAL);
+            bytes = static_cast<const char *>(addr);
+            length = info.st_size;
+            mapped = true;
+        }
+    }
+    close(fd);
+    if (mapped) {
+        return;
+    }
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw ReaderError("Error opening file: " + path);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+/// Unmaps the file
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (mapped) {
+        munmap(const_cast<char *>(bytes), length);
+    }
+#endif
+}
+
+/// Pointer to the first byte of the file
+const char * MappedFile::data() const
+{
+    return bytes;
+}
+
+/// Size of the file in bytes
+std::size_t MappedFile::size() const
+{
+    return length;
+}
@@ -0,0 +1,48 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/** @file MappedFile.h
+ * @brief Header file for read-only memory-mapped files.
+ */
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ * The mapping is released on destruction. On platforms without mmap the file is
+ * read into a buffer instead, behind the same interface.
+ */
+class MappedFile
+{
+    private:
+        const char * bytes; /// First byte of the file
+        std::size_t length; /// Size of the file in bytes
+        bool mapped; /// True if bytes points to a mapping, false if it points to buffer
+        std::string buffer; /// File contents when the file is not mapped
+    public:
+        /**
+         * @brief Maps a file into memory.
+         * @param path Path of the file.
+         * @throws ReaderError if the file cannot be opened.
+         */
+        MappedFile(std::string const& path);
+        /// Unmaps the file
+        ~MappedFile();
+        MappedFile(MappedFile const&) = delete;
+        MappedFile & operator=(MappedFile const&) = delete;
+        /**
+         * @brief Method to get the contents of the file
+         * @return Pointer to the first byte of the file
+         */
+        const char * data() const;
+        /**
+         * @brief Method to get the size of the file
+         * @return Size of the file in bytes
+         */
+        std::size_t size() const;
+};
+
+#endif //MAPPEDFILE_H
@@ -1,16 +1,26 @@
 #ifndef OUTPUTDATA_H
 #define OUTPUTDATA_H
 
+#include <string>
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+
 /**
  * @struct OutputData
  * @brief Container for the output of a solver.
  */
 struct OutputData {
     std::string method;
+    /// Error estimate of the method, for the balanced matrix @f$ D^{-1} A D @f$ if the input was balanced
     double estimated_error;
     double execution_time;
     int iterations;
     Eigen::VectorXcd estimated_eigenvalues;
+    /// Eigenvector approximations, one per column, empty for methods that do not compute them
+    Eigen::MatrixXcd estimated_eigenvectors;
+    /// Additional method specific metrics as (name, value) pairs
+    std::vector<std::pair<std::string, std::string>> metrics;
 };
 
 #endif //OUTPUTDATA_H
\ No newline at end of file
@@ -73,6 +73,9 @@ void OutputGenerator::saveOutput() {
         std::cout << "Error: " + std::to_string(out.estimated_error) << std::endl;
         std::cout << "Execution Time: " + std::to_string(out.execution_time) + " microseconds" << std::endl;
         std::cout << "Iterations: " + std::to_string(out.iterations) << std::endl;
+        for (auto const& metric : out.metrics) {
+            std::cout << metric.first + ": " + metric.second << std::endl;
+        }
         return;
     }
 
@@ -140,6 +143,9 @@ void OutputGenerator::saveOutput() {
     htmlFile << "<tr><td>Estimated Error</td><td>" + std::to_string(out.estimated_error) + "</td></tr>";
     htmlFile << "<tr><td>Execution Time</td><td>" + std::to_string(out.execution_time) + " microseconds</td></tr>";
     htmlFile << "<tr><td>Iterations</td><td>" + std::to_string(out.iterations) + "</td></tr>";
+    for (auto const& metric : out.metrics) {
+        htmlFile << "<tr><td>" + metric.first + "</td><td>" + metric.second + "</td></tr>";
+    }
 
     htmlFile << R"(
     </table>
@@ -2,14 +2,30 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <cstring>
+#include <cctype>
+#include <charconv>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
 #include <nlohmann/json.hpp>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image/stb_image.h"
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "stb_image/stb_image_resize2.h"
 #include <exprtk/exprtk.hpp>
 #include "utils.h"
 #include "InputData.h"
 #include "Reader.h"
 #include "Exceptions.h"
+#include "MappedFile.h"
+#include "BinaryMatrix.h"
+#include "FunctionOperator.h"
+#include "ToeplitzOperator.h"
 
 /** @file Reader.cpp
  * @brief Implementation file for Reader based classes.
@@ -38,10 +54,11 @@ Reader::Reader(std::string const& method, int const& num_iters,
  * @param tol The tolerance level.
  * @param opt_params A JSON object containing additional optional parameters.
  * @param path A path for a file containing the input matrix.
+ * @param num_threads Number of parsing threads, 0 uses all hardware threads.
  */
 FileReader::FileReader(std::string const& method, int const& num_iters, double const& tol,
-    nlohmann::json const& opt_params, std::string const& path)
-    : Reader(method, num_iters, tol, opt_params)
+    nlohmann::json const& opt_params, std::string const& path, int num_threads)
+    : Reader(method, num_iters, tol, opt_params), num_threads(num_threads)
 {
     file_path = path;
 }
@@ -54,10 +71,16 @@ FileReader::FileReader(std::string const& method, int const& num_iters, double c
  * @param opt_params A JSON object containing additional optional parameters.
  * @param func The function defining the input matrix.
  * @param size The size of the matrix desired.
+ * @param symmetric If true only the upper triangle is evaluated and mirrored.
+ * @param num_threads Number of generating threads, 0 uses all hardware threads.
+ * @param matrix_free If true the matrix is not stored, its entries are evaluated during every product.
+ * @param structure "NONE", "AUTO" to probe for a Toeplitz or circulant structure, "TOEPLITZ" or "CIRCULANT".
  */
 FunctionReader::FunctionReader(std::string const& method, int const& num_iters,
-    double const& tol, nlohmann::json const& opt_params, std::string const& genFunc, int const& size)
-    : Reader(method, num_iters, tol, opt_params)
+    double const& tol, nlohmann::json const& opt_params, std::string const& genFunc, int const& size,
+    bool symmetric, int num_threads, bool matrix_free, std::string const& structure)
+    : Reader(method, num_iters, tol, opt_params), symmetric(symmetric), num_threads(num_threads),
+      matrix_free(matrix_free), structure(structure)
 {
     func = genFunc;
     input_data.size = size;
@@ -70,26 +93,111 @@ FunctionReader::FunctionReader(std::string const& method, int const& num_iters,
  * @param tol The tolerance level.
  * @param opt_params A JSON object containing additional optional parameters.
  * @param path A file path for the input image.
+ * @param levels Number of pyramid levels, 1 solves the image directly.
+ * @param target_size Size of the finest level, 0 keeps the size of the image.
  */
 PictureReader::PictureReader(std::string const& method, int const& num_iters,
-    double const& tol, nlohmann::json const& opt_params, std::string const& img_path)
-    : Reader(method, num_iters, tol, opt_params)
+    double const& tol, nlohmann::json const& opt_params, std::string const& img_path,
+    int levels, int target_size)
+    : Reader(method, num_iters, tol, opt_params), levels(levels), target_size(target_size)
 {
     path = img_path;
 }
 
+/**
+ * @brief Constructor for SparseFileReader
+ * @param method The method to be used to find the eigenvalues.
+ * @param num_iters The maximum number of iterations.
+ * @param tol The tolerance level.
+ * @param opt_params A JSON object containing additional optional parameters.
+ * @param path A path for a file containing the matrix entries.
+ */
+SparseFileReader::SparseFileReader(std::string const& method, int const& num_iters,
+    double const& tol, nlohmann::json const& opt_params, std::string const& path)
+    : Reader(method, num_iters, tol, opt_params)
+{
+    file_path = path;
+}
+
+/**
+ * @brief Constructor for BinaryFileReader
+ * @param method The method to be used to find the eigenvalues.
+ * @param num_iters The maximum number of iterations.
+ * @param tol The tolerance level.
+ * @param opt_params A JSON object containing additional optional parameters.
+ * @param path A path for a binary matrix file.
+ * @param block_budget Memory budget in bytes for streaming the file out of core, 0 maps the whole file.
+ */
+BinaryFileReader::BinaryFileReader(std::string const& method, int const& num_iters,
+    double const& tol, nlohmann::json const& opt_params, std::string const& path,
+    std::size_t block_budget)
+    : Reader(method, num_iters, tol, opt_params), block_budget(block_budget)
+{
+    file_path = path;
+}
+
+/**
+ * @brief Constructor for MatrixMarketReader
+ * @param method The method to be used to find the eigenvalues.
+ * @param num_iters The maximum number of iterations.
+ * @param tol The tolerance level.
+ * @param opt_params A JSON object containing additional optional parameters.
+ * @param path A path for a Matrix Market file.
+ */
+MatrixMarketReader::MatrixMarketReader(std::string const& method, int const& num_iters,
+    double const& tol, nlohmann::json const& opt_params, std::string const& path)
+    : Reader(method, num_iters, tol, opt_params)
+{
+    file_path = path;
+}
+
 /**
  * @brief Method to retrieve the input data.
- * @return An InputData object containing the matrix and related parameters.
+ * @return A reference to the InputData object containing the matrix and related parameters.
  */
-InputData Reader::getInputData() const
+InputData const& Reader::getInputData() const
 {
     return input_data;
 }
 
+/**
+ * @brief Moves the input data out of the reader, without copying the matrix.
+ * @return The InputData object; the reader is left without matrix.
+ */
+InputData Reader::takeInputData()
+{
+    InputData input = std::move(input_data);
+    input_data.input_matrix.resize(0, 0);
+    input_data.op.reset();
+    input_data.size = 0;
+    return input;
+}
+
+/**
+ * @brief Sets the seed of the solver's random number generator.
+ * @param seed The seed passed on to the solver through the input data.
+ */
+void Reader::setSeed(unsigned int seed)
+{
+    input_data.seed = seed;
+}
+
+/**
+ * @brief Sets whether the input matrix is balanced before solving.
+ * @param balance The flag passed on to the solver through the input data.
+ */
+void Reader::setBalance(bool balance)
+{
+    input_data.balance = balance;
+}
+
 /// Display the input matrix in the terminal.
 void Reader::printMatrix() const
 {
+    if (input_data.input_matrix.size() == 0 && input_data.op) {
+        std::cout << input_data.op->toDense() << std::endl;
+        return;
+    }
     for(int i=0; i<input_data.size; i++) {
         for(int j=0; j<input_data.size; j++) {
             std::cout << input_data.input_matrix(i,j) << " ";
@@ -98,99 +206,340 @@ void Reader::printMatrix() const
     }
 }
 
-/// Implemented method for FileReader to generate an Eigen::MatrixXcd object
-void FileReader::genMatrix()
+/**
+ * @brief Runs a task on several threads.
+ * @param num_threads Number of threads, the calling thread is one of them.
+ * @param task Function called with the thread index in [0, num_threads).
+ */
+static void runThreads(int num_threads, std::function<void(int)> const& task)
 {
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        throw ReaderError("Error opening file: " + file_path);
+    std::vector<std::thread> workers;
+    for (int t=1; t<num_threads; t++) {
+        workers.emplace_back(task, t);
+    }
+    task(0);
+    for (auto & worker : workers) {
+        worker.join();
     }
+}
+
+/**
+ * @brief Implemented method for FileReader to generate an Eigen::MatrixXcd object
+ * 
+ * The memory-mapped file is split into byte chunks, one per thread, and every thread
+ * collects the line starts of its chunk. The matrix is then allocated once and every
+ * thread parses a contiguous range of rows straight into it, lexing the cells in place
+ * with lexComplex. Errors are reported for the first bad row, whichever thread found it.
+ */
+void FileReader::genMatrix()
+{
+    MappedFile file(file_path);
     std::cout << "Opening file: " << file_path << " ..." << std::endl << std::flush;
 
-    input_data.size = 0;
-    std::string line;
-    int expected_columns = 0;
+    const char * begin = file.data();
+    const char * last = begin + file.size();
+    // Trailing empty lines are ignored
+    while (last > begin && (last[-1] == '\n' || last[-1] == '\r')) {
+        last--;
+    }
+    if (begin == last) {
+        throw ReaderError("The matrix is not square. Rows: 0, Columns: 0");
+    }
 
-    // Count number of rows and columns (in the first row)
-    while (std::getline(file, line)) {
-        if (input_data.size == 0) {
-            std::stringstream ss(line);
-            std::string cell;
-            while (std::getline(ss, cell, ',')) {
-                expected_columns++;
-            }
+    // Size of the matrix from the number of cells in the first row
+    const char * first_end = static_cast<const char *>(std::memchr(begin, '\n', last - begin));
+    long n = std::count(begin, first_end ? first_end : last, ',') + 1;
+
+    // Small files are not worth splitting, keep chunks of at least 1 MB
+    int threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1L, std::min<long>(threads, (last - begin) >> 20));
+
+    // Line starts of every chunk, found in parallel
+    std::vector<std::vector<const char *>> chunk_starts(threads);
+    auto findLines = [&](int t) {
+        const char * p = begin + (last - begin) * t / threads;
+        const char * chunk_end = begin + (last - begin) * (t + 1) / threads;
+        if (t == 0) {
+            chunk_starts[t].push_back(begin);
+        }
+        while ((p = static_cast<const char *>(std::memchr(p, '\n', chunk_end - p))) != nullptr) {
+            p++;
+            chunk_starts[t].push_back(p);
         }
-        input_data.size++;
+    };
+    runThreads(threads, findLines);
+    std::vector<const char *> line_starts;
+    for (auto const& starts : chunk_starts) {
+        line_starts.insert(line_starts.end(), starts.begin(), starts.end());
     }
-
-    if (input_data.size != expected_columns) {
-        throw ReaderError("The matrix is not square. Rows: " + std::to_string(input_data.size) + ", Columns: " + std::to_string(expected_columns));
+    long rows = line_starts.size();
+    if (rows != n) {
+        throw ReaderError("The matrix is not square. Rows: " + std::to_string(rows) + ", Columns: " + std::to_string(n));
     }
 
-    file.clear();
-    file.seekg(0);
-
-    Eigen::MatrixXcd A(input_data.size, input_data.size);
-    long row = 0;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string cell;
-        long col = 0;
-        while (getline(ss, cell, ',') && col < input_data.size) {
-            try {
-                A(row, col) = parseComplex(cell);
-            } catch (const std::invalid_argument& e) {
-                std::cerr << "FATAL ERRROR: Invalid number at row " << row << ", column " << col << std::endl << std::flush;
-                std::exit(EXIT_FAILURE);
+    // Every thread parses its own rows into the matrix
+    Eigen::MatrixXcd A(n, n);
+    std::vector<long> error_rows(threads, n);
+    std::vector<std::string> errors(threads);
+    auto parseRows = [&](int t) {
+        for (long row = n * t / threads; row < n * (t + 1) / threads; row++) {
+            const char * p = line_starts[row];
+            const char * line_end = (row + 1 < n) ? line_starts[row + 1] - 1 : last;
+            bool blank = (line_end - p == 0) || (line_end - p == 1 && *p == '\r');
+            long col = 0;
+            while (!blank && p <= line_end && col < n) {
+                Eigen::dcomplex value;
+                const char * cell_end = lexComplex(p, line_end, value);
+                if (cell_end == nullptr || (cell_end != line_end && *cell_end != ',')) {
+                    error_rows[t] = row;
+                    errors[t] = "Invalid number at row " + std::to_string(row) + ", column " + std::to_string(col);
+                    return;
+                }
+                A(row, col) = value;
+                col++;
+                p = cell_end + 1;
+            }
+            // check for column mismatch
+            if (col != n || p <= line_end) {
+                error_rows[t] = row;
+                errors[t] = "Row " + std::to_string(row) + " does not have " + std::to_string(n) + " columns.";
+                return;
             }
-            col++;
         }
+    };
+    runThreads(threads, parseRows);
 
-        // check for column mismatch
-        if (col != input_data.size) {
-            throw ReaderError("Row " + std::to_string(row) + " does not have " + std::to_string(input_data.size) + " columns.");
-        }
+    int first_error = std::min_element(error_rows.begin(), error_rows.end()) - error_rows.begin();
+    if (error_rows[first_error] < n) {
+        throw ReaderError(errors[first_error]);
+    }
+    input_data.size = n;
+    input_data.input_matrix = std::move(A);
+}
 
-        row++;
+/**
+ * @brief Builds the structured operator of the function from its first row and column.
+ * 
+ * With the "TOEPLITZ" and "CIRCULANT" hints the structure is trusted, and for a
+ * circulant matrix only the first column is evaluated. With "AUTO" the entries at 8n
+ * random positions must match the first row and column, and the rows must also be
+ * rotations of each other for a circulant matrix. Probing costs O(n) evaluations; it
+ * cannot prove the structure, so a hint should be preferred when it is known.
+ * @return Shared pointer to a ToeplitzOperator, empty if probing found no structure.
+ */
+std::shared_ptr<ToeplitzOperator> FunctionReader::probeStructure() const
+{
+    long n = input_data.size;
+    double i, j;
+    exprtk::symbol_table<double> symbol_table;
+    symbol_table.add_variable("i", i);
+    symbol_table.add_variable("j", j);
+    exprtk::expression<double> expression;
+    expression.register_symbol_table(symbol_table);
+    exprtk::parser<double> parser;
+    if (!parser.compile(func, expression)) {
+        throw ReaderError("Invalid matrix generating function: " + parser.error());
     }
-    file.close();
+    auto f = [&](long row, long col) {
+        i = row + 1;
+        j = col + 1;
+        return expression.value();
+    };
 
-    input_data.input_matrix = A;
+    Eigen::VectorXcd first_col(n), first_row(n);
+    for (long k=0; k<n; k++) {
+        first_col(k) = f(k, 0);
+    }
+    bool toeplitz = true;
+    bool circulant = (structure == "CIRCULANT");
+    if (!circulant) {
+        for (long k=0; k<n; k++) {
+            first_row(k) = f(0, k);
+        }
+    }
+    if (structure == "AUTO") {
+        auto matches = [](double value, double expected) {
+            return std::abs(value - expected) <= 1e-12 * std::max(1.0, std::abs(expected));
+        };
+        std::mt19937 gen(n);
+        std::uniform_int_distribution<long> index(0, n - 1);
+        for (long s=0; s<8*n && toeplitz; s++) {
+            long row = index(gen), col = index(gen);
+            double expected = (row >= col) ? first_col(row - col).real() : first_row(col - row).real();
+            toeplitz = matches(f(row, col), expected);
+        }
+        circulant = toeplitz;
+        for (long k=1; k<n && circulant; k++) {
+            circulant = matches(first_row(k).real(), first_col(n - k).real());
+        }
+    }
+    if (!toeplitz) {
+        return nullptr;
+    }
+    if (circulant) {
+        first_row(0) = first_col(0);
+        for (long k=1; k<n; k++) {
+            first_row(k) = first_col(n - k);
+        }
+    }
+    return std::make_shared<ToeplitzOperator>(first_col, first_row);
 }
-/// Implemented method for FunctionReader to generate an Eigen::MatrixXcd object
+
+/**
+ * @brief Implemented method for FunctionReader to generate an Eigen::MatrixXcd object
+ * 
+ * The expression is interpreted by exprtk one entry at a time, so the columns are
+ * spread over several threads, each with its own compiled expression. With the
+ * symmetry hint only the upper triangle is evaluated and then mirrored. The
+ * generation time is added to the metrics of the input. Structured functions and
+ * matrix-free mode only create an operator, which mirrors the upper triangle too.
+ */
 void FunctionReader::genMatrix()
 {
     if (input_data.size <= 0) {
         throw ReaderError("Error: size must be non-negative.");
     }
+    if (structure != "NONE") {
+        std::shared_ptr<ToeplitzOperator> structured = probeStructure();
+        if (structured) {
+            std::string name = structured->isCirculant() ? "Circulant" : "Toeplitz";
+            std::cout << name << " function, storing its first row and column only." << std::endl << std::flush;
+            input_data.op = structured;
+            input_data.hermitian = structured->isHermitian();
+            input_data.metrics.emplace_back("Structure", name);
+            return;
+        }
+        std::cout << "No Toeplitz structure found in the function." << std::endl << std::flush;
+    }
+    if (matrix_free) {
+        input_data.op = std::make_shared<FunctionOperator>(func, input_data.size, num_threads, symmetric);
+        input_data.hermitian = symmetric;
+        return;
+    }
+    auto start_time = std::chrono::high_resolution_clock::now();
+    long n = input_data.size;
 
-    Eigen::MatrixXcd A(input_data.size, input_data.size);
-    double i, j;
+    // Compiled once up front so that syntax errors are reported before any thread starts
+    {
+        exprtk::expression<double> expression;
+        exprtk::parser<double> parser;
+        exprtk::symbol_table<double> symbol_table;
+        symbol_table.add_constant("i", 1);
+        symbol_table.add_constant("j", 1);
+        expression.register_symbol_table(symbol_table);
+        if (!parser.compile(func, expression)) {
+            throw ReaderError("Invalid matrix generating function: " + parser.error());
+        }
+    }
 
-    exprtk::symbol_table<double> symbol_table;
-    symbol_table.add_variable("i", i);
-    symbol_table.add_variable("j", j);
-    exprtk::expression<double> expression;
-    expression.register_symbol_table(symbol_table);
+    // Blocks of columns are handed out dynamically, the triangle makes them uneven
+    const long block = 64;
+    long num_blocks = (n + block - 1) / block;
+    int threads = num_threads > 0 ? num_threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1L, std::min<long>(threads, num_blocks));
+    Eigen::MatrixXcd A(n, n);
+    std::atomic<long> next_block(0);
 
-    exprtk::parser<double> parser;
-    parser.compile(func, expression);
+    // Every thread owns its variables, symbol table and compiled expression, and fills
+    // whole columns in memory order
+    auto generate = [&](int /*t*/) {
+        double i, j;
+        exprtk::symbol_table<double> symbol_table;
+        symbol_table.add_variable("i", i);
+        symbol_table.add_variable("j", j);
+        exprtk::expression<double> expression;
+        expression.register_symbol_table(symbol_table);
+        exprtk::parser<double> parser;
+        parser.compile(func, expression);
 
-    for(int row = 0; row < input_data.size; row++) {
-        for(int col = 0; col<input_data.size; col++) {
-            i = row + 1;
-            j = col + 1;
-            A(row,col) = expression.value();
+        long b;
+        while ((b = next_block++) < num_blocks) {
+            for (long col = b * block; col < std::min(n, (b + 1) * block); col++) {
+                j = col + 1;
+                long rows = symmetric ? col + 1 : n;
+                Eigen::dcomplex * column = A.col(col).data();
+                for (long row = 0; row < rows; row++) {
+                    i = row + 1;
+                    column[row] = expression.value();
+                }
+            }
         }
+    };
+    runThreads(threads, generate);
+
+    if (symmetric) {
+        A.triangularView<Eigen::StrictlyLower>() = A.transpose();
+        // A real symmetric matrix is Hermitian, the solvers can rely on it
+        input_data.hermitian = true;
     }
-    input_data.input_matrix = A;
+    input_data.input_matrix = std::move(A);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double generation_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    input_data.metrics.emplace_back("Generation Time", std::to_string(generation_time) + " microseconds");
+    input_data.metrics.emplace_back("Generation Threads", std::to_string(threads));
 }
 
-/// Implemented method for PictureReader to generate an Eigen::MatrixXcd object
+/**
+ * @brief Fills a matrix with the top-left square of a grey image, resized to m x m.
+ *
+ * The matrix is only reallocated if its size changes, so that it can be reused for
+ * images of the same size.
+ * @param data Pixels of the image, one byte each.
+ * @param width Width of the image, the rows of the image are width bytes apart.
+ * @param sz Side of the square, at most the width and the height.
+ * @param m Side of the matrix.
+ * @param A Output matrix.
+ */
+static void squareLevel(const unsigned char * data, int width, int sz, int m, Eigen::MatrixXcd & A)
+{
+    std::vector<unsigned char> pixels;
+    const unsigned char * src = data;
+    int stride = width;
+    if (m != sz) {
+        pixels.resize(static_cast<std::size_t>(m) * m);
+        stbir_resize_uint8_linear(data, sz, sz, width, pixels.data(), m, m, m, STBIR_1CHANNEL);
+        src = pixels.data();
+        stride = m;
+    }
+    A.resize(m, m);
+    for(int i=0; i<m; i++) {
+        for(int j=0; j<m; j++) {
+            A(i,j) = static_cast<double>(src[static_cast<std::size_t>(i)*stride + j]);
+        }
+    }
+}
+
+/**
+ * @brief Decodes an image into a matrix, without messages.
+ * @param path File path of the image.
+ * @param target_size Side of the matrix, 0 keeps the smaller side of the image.
+ * @param A Output matrix, only reallocated if its size changes.
+ * @throws ReaderError if the image cannot be decoded.
+ */
+void loadPicture(std::string const& path, int target_size, Eigen::MatrixXcd & A)
+{
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 1);
+    if (!data) {
+        throw ReaderError("Error opening image: " + path);
+    }
+    int sz = std::min(height, width);
+    squareLevel(data, width, sz, (target_size > 0) ? std::min(target_size, sz) : sz, A);
+    stbi_image_free(data);
+}
+
+/**
+ * @brief Implemented method for PictureReader to generate an Eigen::MatrixXcd object
+ * 
+ * The image is cropped to a square. If a target size is given the square is downsampled
+ * to it with stb_image_resize2. With several levels, copies of half, a quarter... of the
+ * finest size are added to the input, coarsest first.
+ */
 void PictureReader::genMatrix() {
-    int height, width, channels;
+    int width, height, channels;
     const char * img_path = path.c_str();
-    unsigned char* data = stbi_load(img_path, &height, &width, &channels, 1);
+    unsigned char* data = stbi_load(img_path, &width, &height, &channels, 1);
     if (!data) {
         throw ReaderError("Error opening image: " + path);
     }
@@ -198,14 +547,261 @@ void PictureReader::genMatrix() {
         std::cerr << "WARNING: height must be equal to width. Cropping." << std::endl;
     }
     std::cout << "Opening image: " << path << std::endl;
+    auto start_time = std::chrono::high_resolution_clock::now();
     int sz = std::min(height,width);
-    Eigen::MatrixXcd A(sz,sz);
-    for(int i=0; i<sz; i++) {
-        for(int j=0; j<sz; j++) {
-            A(i,j) = static_cast<double>(data[i*sz + j]);
-        }
+
+    auto level = [&](int m) {
+        Eigen::MatrixXcd A;
+        squareLevel(data, width, sz, m, A);
+        return A;
+    };
+
+    int finest = (target_size > 0) ? std::min(target_size, sz) : sz;
+    input_data.input_matrix = level(finest);
+    input_data.size = finest;
+    input_data.coarse_levels.clear();
+    for (int l=1; l<levels && (finest >> l) >= 2; l++) {
+        input_data.coarse_levels.insert(input_data.coarse_levels.begin(), level(finest >> l));
     }
-    input_data.input_matrix = A;
-    std::cout << "Successfully loaded picture as matrix." << std::endl;
     stbi_image_free(data);
+
+    if (finest != sz || !input_data.coarse_levels.empty()) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        double pyramid_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+        input_data.metrics.emplace_back("Pyramid", std::to_string(input_data.coarse_levels.size() + 1) + " levels from "
+            + std::to_string(sz) + "x" + std::to_string(sz) + " to " + std::to_string(finest) + "x" + std::to_string(finest));
+        input_data.metrics.emplace_back("Pyramid Time", std::to_string(pyramid_time) + " microseconds");
+    }
+    std::cout << "Successfully loaded picture as matrix." << std::endl;
+}
+
+/// Implemented method for SparseFileReader to generate a CSR operator
+void SparseFileReader::genMatrix()
+{
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        throw ReaderError("Error opening file: " + file_path);
+    }
+    std::cout << "Opening sparse file: " << file_path << " ..." << std::endl << std::flush;
+
+    // Header with the dimensions
+    std::string line, cell;
+    long rows = 0, cols = 0;
+    if (!std::getline(file, line)) {
+        throw ReaderError("Missing matrix dimensions in " + file_path);
+    }
+    try {
+        std::stringstream ss(line);
+        std::getline(ss, cell, ',');
+        rows = std::stol(cell);
+        std::getline(ss, cell, ',');
+        cols = std::stol(cell);
+    } catch (const std::exception& e) {
+        throw ReaderError("Invalid matrix dimensions: " + line);
+    }
+    if (rows != cols) {
+        throw ReaderError("The matrix is not square. Rows: " + std::to_string(rows) + ", Columns: " + std::to_string(cols));
+    }
+    if (rows <= 0) {
+        throw ReaderError("Error: size must be positive.");
+    }
+    input_data.size = rows;
+
+    // Entries, duplicates are summed
+    std::vector<Eigen::Triplet<Eigen::dcomplex>> entries;
+    long line_num = 1;
+    while (std::getline(file, line)) {
+        line_num++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::stringstream ss(line);
+        long row, col;
+        Eigen::dcomplex value;
+        try {
+            std::getline(ss, cell, ',');
+            row = std::stol(cell);
+            std::getline(ss, cell, ',');
+            col = std::stol(cell);
+            std::getline(ss, cell);
+            value = parseComplex(cell);
+        } catch (const std::exception& e) {
+            throw ReaderError("Invalid entry at line " + std::to_string(line_num) + ": " + line);
+        }
+        if (row < 1 || row > rows || col < 1 || col > cols) {
+            throw ReaderError("Entry out of range at line " + std::to_string(line_num) + ": " + line);
+        }
+        entries.emplace_back(row - 1, col - 1, value);
+    }
+    file.close();
+
+    Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> A(rows, cols);
+    A.setFromTriplets(entries.begin(), entries.end());
+    input_data.op = std::make_shared<SparseOperator>(std::move(A));
+    std::cout << "Successfully loaded sparse matrix with " << entries.size() << " entries." << std::endl;
+}
+
+/// Implemented method for BinaryFileReader to map or stream the matrix as an operator
+void BinaryFileReader::genMatrix()
+{
+    if (block_budget > 0) {
+        std::cout << "Streaming binary file: " << file_path << " ..." << std::endl << std::flush;
+        input_data.op = std::make_shared<OutOfCoreOperator>(file_path, block_budget);
+    }
+    else {
+        std::cout << "Mapping binary file: " << file_path << " ..." << std::endl << std::flush;
+        input_data.op = mapBinaryMatrix(file_path);
+    }
+    input_data.size = input_data.op->size();
+}
+
+/**
+ * @brief Implemented method for MatrixMarketReader to generate a sparse operator or a dense matrix
+ * 
+ * Streams once over the memory-mapped file: the header and size lines are split into
+ * tokens, the entries are lexed in place with std::from_chars. Entries may be spread
+ * over lines arbitrarily, as allowed by the format.
+ */
+void MatrixMarketReader::genMatrix()
+{
+    MappedFile file(file_path);
+    std::cout << "Opening Matrix Market file: " << file_path << " ..." << std::endl << std::flush;
+
+    const char * p = file.data();
+    const char * last = p + file.size();
+    long line_num = 1;
+
+    // Header: %%MatrixMarket matrix <format> <field> <symmetry>
+    const char * header_end = static_cast<const char *>(std::memchr(p, '\n', last - p));
+    std::string header(p, header_end ? header_end : last);
+    std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+    std::stringstream ss(header);
+    std::string banner, object, format, field, symmetry;
+    ss >> banner >> object >> format >> field >> symmetry;
+    if (banner != "%%matrixmarket" || object != "matrix") {
+        throw ReaderError("Invalid Matrix Market header in " + file_path);
+    }
+    bool coordinate = (format == "coordinate");
+    if (!coordinate && format != "array") {
+        throw ReaderError("Unsupported Matrix Market format: " + format);
+    }
+    if (field != "real" && field != "integer" && field != "complex" && field != "pattern") {
+        throw ReaderError("Unsupported Matrix Market field: " + field);
+    }
+    if (field == "pattern" && !coordinate) {
+        throw ReaderError("Pattern Matrix Market files must be in coordinate format.");
+    }
+    if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric" && symmetry != "hermitian") {
+        throw ReaderError("Unsupported Matrix Market symmetry: " + symmetry);
+    }
+    p = header_end ? header_end + 1 : last;
+    line_num++;
+
+    // Skips blanks, line breaks and comment lines, counting the lines
+    auto skip = [&]() {
+        while (p < last) {
+            if (*p == '\n') {
+                line_num++;
+                p++;
+            }
+            else if (*p == ' ' || *p == '\t' || *p == '\r') {
+                p++;
+            }
+            else if (*p == '%') {
+                const char * eol = static_cast<const char *>(std::memchr(p, '\n', last - p));
+                p = eol ? eol : last;
+            }
+            else {
+                break;
+            }
+        }
+    };
+    auto lexNumber = [&](auto & x) {
+        skip();
+        if (p < last && *p == '+') {
+            p++;
+        }
+        auto [ptr, ec] = std::from_chars(p, last, x);
+        if (ec != std::errc() || (ptr < last && !std::isspace(static_cast<unsigned char>(*ptr)))) {
+            throw ReaderError("Invalid entry at line " + std::to_string(line_num) + " of " + file_path);
+        }
+        p = ptr;
+    };
+    auto lexValue = [&]() {
+        double re = 1.0, im = 0.0;
+        if (field != "pattern") {
+            lexNumber(re);
+        }
+        if (field == "complex") {
+            lexNumber(im);
+        }
+        return Eigen::dcomplex(re, im);
+    };
+
+    // Size line
+    long rows, cols, nnz = 0;
+    lexNumber(rows);
+    lexNumber(cols);
+    if (coordinate) {
+        lexNumber(nnz);
+    }
+    if (rows != cols) {
+        throw ReaderError("The matrix is not square. Rows: " + std::to_string(rows) + ", Columns: " + std::to_string(cols));
+    }
+    if (rows <= 0) {
+        throw ReaderError("Error: size must be positive.");
+    }
+    long n = rows;
+    input_data.size = n;
+    input_data.hermitian = (symmetry == "hermitian") || (symmetry == "symmetric" && field != "complex");
+
+    // Value of the mirrored entry of the other triangle
+    auto mirror = [&symmetry](Eigen::dcomplex v) {
+        if (symmetry == "skew-symmetric") {
+            return -v;
+        }
+        return symmetry == "hermitian" ? std::conj(v) : v;
+    };
+
+    if (coordinate) {
+        std::vector<Eigen::Triplet<Eigen::dcomplex>> entries;
+        entries.reserve(symmetry == "general" ? nnz : 2 * nnz);
+        for (long k = 0; k < nnz; k++) {
+            long i, j;
+            lexNumber(i);
+            lexNumber(j);
+            long entry_line = line_num;
+            Eigen::dcomplex value = lexValue();
+            if (i < 1 || i > n || j < 1 || j > n) {
+                throw ReaderError("Entry out of range at line " + std::to_string(entry_line) + " of " + file_path);
+            }
+            entries.emplace_back(i - 1, j - 1, value);
+            if (symmetry != "general" && i != j) {
+                entries.emplace_back(j - 1, i - 1, mirror(value));
+            }
+        }
+        Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> A(n, n);
+        A.setFromTriplets(entries.begin(), entries.end());
+        input_data.op = std::make_shared<SparseOperator>(std::move(A));
+    }
+    else {
+        // Column-major values, only the lower triangle for the symmetric variants
+        Eigen::MatrixXcd A = Eigen::MatrixXcd::Zero(n, n);
+        for (long j = 0; j < n; j++) {
+            long first_row = (symmetry == "general") ? 0 : (symmetry == "skew-symmetric") ? j + 1 : j;
+            for (long i = first_row; i < n; i++) {
+                A(i, j) = lexValue();
+                if (symmetry != "general" && i != j) {
+                    A(j, i) = mirror(A(i, j));
+                }
+            }
+        }
+        input_data.input_matrix = std::move(A);
+    }
+
+    skip();
+    if (p != last) {
+        throw ReaderError("Too many entries at line " + std::to_string(line_num) + " of " + file_path);
+    }
+    std::cout << "Successfully loaded " << format << " " << symmetry << " matrix of size " << n << "." << std::endl;
 }
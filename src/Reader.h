@@ -4,6 +4,8 @@
 #include "InputData.h"
 #include <nlohmann/json.hpp>
 
+class ToeplitzOperator;
+
 /**
 * @file Reader.h
 * @brief This header file contains the definition
@@ -34,9 +36,24 @@ public:
     virtual ~Reader() {}; 
     /**
      * @brief Method to retrieve the input data.
-     * @return An InputData object containing the matrix and related parameters.
+     * @return A reference to the InputData object containing the matrix and related parameters.
+     */
+    InputData const& getInputData() const;
+    /**
+     * @brief Moves the input data out of the reader, without copying the matrix.
+     * @return The InputData object; the reader is left without matrix.
+     */
+    InputData takeInputData();
+    /**
+     * @brief Sets the seed of the solver's random number generator.
+     * @param seed The seed passed on to the solver through the input data.
+     */
+    void setSeed(unsigned int seed);
+    /**
+     * @brief Sets whether the input matrix is balanced before solving.
+     * @param balance The flag passed on to the solver through the input data.
      */
-    InputData getInputData() const;
+    void setBalance(bool balance);
     /// Display matrix
     void printMatrix() const;
     /**
@@ -55,6 +72,8 @@ class FileReader : public Reader
 protected:
     /// Path to the file containing the matrix data
     std::string file_path;
+    /// Number of parsing threads, 0 uses all hardware threads
+    int num_threads;
 public:
     /**
      * @brief Constructor for FileReader
@@ -63,9 +82,11 @@ public:
      * @param tol The tolerance level.
      * @param opt_params A JSON object containing additional optional parameters.
      * @param path A path for a file containing the input matrix.
+     * @param num_threads Number of parsing threads, 0 uses all hardware threads.
      */
     FileReader(std::string const& method, int const& num_iters,
-        double const& tol, nlohmann::json const& opt_params, std::string const& path);
+        double const& tol, nlohmann::json const& opt_params, std::string const& path,
+        int num_threads = 0);
     /// FileReader destructor
     ~FileReader() {};
     /// Implemented method to generate an Eigen::MatrixXcd object
@@ -75,12 +96,32 @@ public:
 /**
  * @class FunctionReader
  * @brief Derived class that creates the input matrix from a user-defined function.
+ *
+ * The matrix is generated in parallel, every thread compiling its own copy of the
+ * expression. With the symmetry hint only the upper triangle is evaluated. In
+ * matrix-free mode the matrix is not generated at all, the solvers get a
+ * FunctionOperator evaluating the entries during every product instead. Toeplitz and
+ * circulant functions, given as a hint or detected by probing, are stored by their
+ * first row and column only.
  */
 class FunctionReader : public Reader
 {
 protected:
     /// Function definition
     std::string func;
+    /// If true the function is assumed symmetric in i and j
+    bool symmetric;
+    /// Number of generating threads, 0 uses all hardware threads
+    int num_threads;
+    /// If true the entries are evaluated during every product instead of stored
+    bool matrix_free;
+    /// Structure of the function: "NONE", "AUTO" (probed), "TOEPLITZ" or "CIRCULANT"
+    std::string structure;
+    /**
+     * @brief Builds the structured operator of the function from its first row and column.
+     * @return Shared pointer to a ToeplitzOperator, empty if probing found no structure.
+     */
+    std::shared_ptr<ToeplitzOperator> probeStructure() const;
 public:
     /**
      * @brief Constructor for FunctionReader
@@ -90,9 +131,15 @@ public:
      * @param opt_params A JSON object containing additional optional parameters.
      * @param func The function defining the input matrix.
      * @param size The size of the matrix desired.
+     * @param symmetric If true only the upper triangle is evaluated and mirrored.
+     * @param num_threads Number of generating threads, 0 uses all hardware threads.
+     * @param matrix_free If true the matrix is not stored, its entries are evaluated during every product.
+     * @param structure "NONE", "AUTO" to probe for a Toeplitz or circulant structure, "TOEPLITZ" or "CIRCULANT".
      */
     FunctionReader(std::string const& method, int const& num_iters, double const& tol,
-        nlohmann::json const& opt_params, std::string const& func, int const& size);
+        nlohmann::json const& opt_params, std::string const& func, int const& size,
+        bool symmetric = false, int num_threads = 0, bool matrix_free = false,
+        std::string const& structure = "NONE");
     /// FunctionReader destructor
     ~FunctionReader() {};
     /// Implemented method to generate an Eigen::MatrixXcd object
@@ -102,12 +149,19 @@ public:
 /**
  * @class PictureReader
  * @brief Derived class that creates the input matrix from an image.
+ *
+ * The image can be downsampled to a target size, and coarser copies halving the size
+ * at every level can be added for coarse-to-fine solves.
  */
 class PictureReader : public Reader
 {
 protected:
     /// Path for image
     std::string path;
+    /// Number of pyramid levels, including the finest one
+    int levels;
+    /// Size of the finest level, 0 keeps the size of the image
+    int target_size;
 public:
     /**
      * @brief Constructor for PictureReader
@@ -116,14 +170,124 @@ public:
      * @param tol The tolerance level.
      * @param opt_params A JSON object containing additional optional parameters.
      * @param path A file path for the input image.
+     * @param levels Number of pyramid levels, 1 solves the image directly.
+     * @param target_size Size of the finest level, 0 keeps the size of the image.
      */
     PictureReader(std::string const& method, int const& num_iters,
-        double const& tol, nlohmann::json const& opt_params, std::string const& path);
+        double const& tol, nlohmann::json const& opt_params, std::string const& path,
+        int levels = 1, int target_size = 0);
     /// PictureReader destructor
     ~PictureReader() {};
     /// Implemented method to generate an Eigen::MatrixXcd object
     void genMatrix();
 };
 
+/**
+ * @brief Decodes an image into a matrix, without messages.
+ *
+ * The top-left square of the image is used, resized to the target size if it is smaller.
+ * @param path File path of the image.
+ * @param target_size Side of the matrix, 0 keeps the smaller side of the image.
+ * @param A Output matrix, only reallocated if its size changes.
+ * @throws ReaderError if the image cannot be decoded.
+ */
+void loadPicture(std::string const& path, int target_size, Eigen::MatrixXcd & A);
+
+/**
+ * @class SparseFileReader
+ * @brief Derived class that reads a sparse input matrix in coordinate format from a file.
+ *
+ * The first line contains the number of rows and columns, every other line an entry
+ * as "row, column, value" with 1-based indices. The matrix is stored as a CSR operator
+ * and never as a dense matrix.
+ */
+class SparseFileReader : public Reader
+{
+protected:
+    /// Path to the file containing the matrix entries
+    std::string file_path;
+public:
+    /**
+     * @brief Constructor for SparseFileReader
+     * @param method The method to be used to find the eigenvalues.
+     * @param num_iters The maximum number of iterations.
+     * @param tol The tolerance level.
+     * @param opt_params A JSON object containing additional optional parameters.
+     * @param path A path for a file containing the matrix entries.
+     */
+    SparseFileReader(std::string const& method, int const& num_iters,
+        double const& tol, nlohmann::json const& opt_params, std::string const& path);
+    /// SparseFileReader destructor
+    ~SparseFileReader() {};
+    /// Implemented method to generate a sparse operator
+    void genMatrix();
+};
+
+/**
+ * @class BinaryFileReader
+ * @brief Derived class that maps an input matrix stored in the binary matrix format.
+ *
+ * The file is memory-mapped and the solvers get an operator viewing the entries in
+ * place, so nothing is parsed or copied when loading. In out-of-core mode the file is
+ * streamed from disk in blocks on every product instead, for matrices larger than memory.
+ */
+class BinaryFileReader : public Reader
+{
+protected:
+    /// Path to the binary matrix file
+    std::string file_path;
+    /// Memory budget in bytes for streaming the file, 0 maps the whole file instead
+    std::size_t block_budget;
+public:
+    /**
+     * @brief Constructor for BinaryFileReader
+     * @param method The method to be used to find the eigenvalues.
+     * @param num_iters The maximum number of iterations.
+     * @param tol The tolerance level.
+     * @param opt_params A JSON object containing additional optional parameters.
+     * @param path A path for a binary matrix file.
+     * @param block_budget Memory budget in bytes for streaming the file out of core, 0 maps the whole file.
+     */
+    BinaryFileReader(std::string const& method, int const& num_iters,
+        double const& tol, nlohmann::json const& opt_params, std::string const& path,
+        std::size_t block_budget = 0);
+    /// BinaryFileReader destructor
+    ~BinaryFileReader() {};
+    /// Implemented method to map or stream the matrix as an operator
+    void genMatrix();
+};
+
+/**
+ * @class MatrixMarketReader
+ * @brief Derived class that reads an input matrix in the Matrix Market (.mtx) format.
+ *
+ * Coordinate files are stored as a CSR operator, array files as a dense matrix. The
+ * real, integer, complex and pattern fields and the general, symmetric, skew-symmetric
+ * and Hermitian symmetries are supported; for the last three only one triangle is
+ * stored in the file and the other one is filled in. Hermitian (and real symmetric)
+ * headers are passed on to the solvers through InputData::hermitian.
+ */
+class MatrixMarketReader : public Reader
+{
+protected:
+    /// Path to the Matrix Market file
+    std::string file_path;
+public:
+    /**
+     * @brief Constructor for MatrixMarketReader
+     * @param method The method to be used to find the eigenvalues.
+     * @param num_iters The maximum number of iterations.
+     * @param tol The tolerance level.
+     * @param opt_params A JSON object containing additional optional parameters.
+     * @param path A path for a Matrix Market file.
+     */
+    MatrixMarketReader(std::string const& method, int const& num_iters,
+        double const& tol, nlohmann::json const& opt_params, std::string const& path);
+    /// MatrixMarketReader destructor
+    ~MatrixMarketReader() {};
+    /// Implemented method to generate a sparse operator or a dense matrix
+    void genMatrix();
+};
+
 #endif //READER_H
 
@@ -1,6 +1,13 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <random>
+#include <sstream>
 #include <nlohmann/json.hpp>
 #include "Exceptions.h"
 #include "InputData.h"
@@ -15,28 +22,382 @@
 /**
  * @brief Solver constructor to initialize the problem parameters.
  * 
- * Initializes the base class attributes using the provided input data.
+ * Initializes the base class attributes using the provided input data. The matrix,
+ * operator, warm start vectors and metrics are moved out of the input, so the matrix
+ * is never copied; the scalar settings and the method configuration are left in it
+ * for the derived constructors.
  * @param input The input data of the problem to initialize protected attributes.
  */
-Solver::Solver(InputData input) 
+Solver::Solver(InputData && input) 
 {
     n = input.size;
     num_iters = input.num_iters;
     tol = input.tol;
-    A = input.input_matrix;
+    A = std::move(input.input_matrix);
     method_name = input.method;
+    seed = input.seed;
+    rng.seed(seed);
+    output.metrics = std::move(input.metrics);
+    if (input.initial_vectors.rows() == n) {
+        initial_vectors = std::move(input.initial_vectors);
+    }
+    scaling = std::move(input.scaling);
+    if (input.op) {
+        op = std::move(input.op);
+    }
+    else {
+        op = std::make_shared<DenseOperator>(A);
+    }
+}
+
+/**
+ * @brief Materializes the dense input matrix for methods that need access to its entries.
+ * 
+ * Inputs given only as an operator (e.g. sparse matrices) are converted to a dense
+ * matrix. Nothing is done if the dense matrix is already available.
+ */
+void Solver::requireDenseMatrix()
+{
+    if (A.size() == 0 && n > 0) {
+        A = op->toDense();
+    }
+}
+
+/**
+ * @brief Factorizes the shifted matrix @f$ A - \mu I @f$ without building a shifted copy.
+ * 
+ * The diagonal of the input matrix is shifted in place for the factorization and
+ * restored exactly afterwards, so only the factorization holds a second matrix.
+ * @param shift The shift @f$ \mu @f$.
+ * @param type Factorization strategy, see createFactorization.
+ * @return Pointer to the computed factorization.
+ */
+std::unique_ptr<Factorization> Solver::factorizeShifted(Eigen::dcomplex shift, std::string const& type)
+{
+    requireDenseMatrix();
+    Eigen::VectorXcd diagonal = A.diagonal();
+    A.diagonal().array() -= shift;
+    std::unique_ptr<Factorization> decomp = createFactorization(A, type);
+    A.diagonal() = diagonal;
+    return decomp;
+}
+
+/**
+ * @brief Random matrix with real and imaginary parts uniform in [-1, 1].
+ * 
+ * Replaces Eigen's Random, which relies on the global rand() and is therefore neither
+ * reproducible nor safe when several solvers run concurrently.
+ * @param rows Number of rows.
+ * @param cols Number of columns.
+ * @return 'Eigen::MatrixXcd' drawn from the solver's own generator.
+ */
+Eigen::MatrixXcd Solver::randomMatrix(int rows, int cols)
+{
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Eigen::MatrixXcd M(rows, cols);
+    for (int j=0; j<cols; j++) {
+        for (int i=0; i<rows; i++) {
+            M(i, j) = Eigen::dcomplex(dist(rng), dist(rng));
+        }
+    }
+    return M;
+}
+
+/**
+ * @brief Starting block for the iterative methods.
+ * 
+ * Takes as many warm start vectors from the input as available and fills the remaining
+ * columns with random vectors.
+ * @param cols Number of vectors.
+ * @return 'Eigen::MatrixXcd' with cols columns.
+ */
+Eigen::MatrixXcd Solver::startingBlock(int cols)
+{
+    Eigen::MatrixXcd X = randomMatrix(n, cols);
+    int warm = std::min<int>(cols, initial_vectors.cols());
+    if (warm > 0) {
+        X.leftCols(warm) = initial_vectors.leftCols(warm);
+    }
+    return X;
 }
 
 /**
  * @brief PowerBasedSolver constructor to initialize solver specific attributes.
  * 
- * Initializes the shifted matrix by applying the shift value to the input matrix.
+ * Reads the shift, the number of iterations between two convergence checks and the
+ * acceleration. The shifted operator is set up by configureShift, called by the derived
+ * constructors, since an automatic shift depends on the method.
  * @param input The input data of the problem contained in InputData struct.
  */
-PowerBasedSolver::PowerBasedSolver(InputData input) : Solver(input)
+PowerBasedSolver::PowerBasedSolver(InputData && input) : Solver(std::move(input)), product_ready(false),
+    num_checks(0), has_bounds(false), estimation_time(0)
 {
-    std::complex<double> shift = parseComplex(input.method_config.at("SHIFT"));
-    shifted_matrix = A - shift*Eigen::MatrixXcd::Identity(n,n);
+    // "AUTO" is estimated by configureShift
+    json const& shift_value = input.method_config.at("SHIFT");
+    auto_shift = shift_value.is_string() && shift_value.get<std::string>() == "AUTO";
+    shift = auto_shift ? Eigen::dcomplex(0) : parseComplexValue(shift_value);
+    hermitian = input.hermitian;
+    auto_steps = input.method_config.value("AUTO_STEPS", 20);
+    if (auto_steps < 2) {
+        std::cerr << "WARNING: Invalid AUTO_STEPS. Defaulting to 20." << std::endl << std::flush;
+        auto_steps = 20;
+    }
+
+    // Convergence check stride, silently every iteration if missing
+    check_every = input.method_config.value("CHECK_EVERY", 1);
+    if (check_every < 1) {
+        std::cerr << "WARNING: Invalid CHECK_EVERY. Defaulting to 1." << std::endl << std::flush;
+        check_every = 1;
+    }
+
+    // Acceleration of the iteration, silently "NONE" if missing
+    acceleration = input.method_config.value("ACCELERATION", "NONE");
+    std::vector<std::string> supported_accelerations = {"NONE", "AITKEN", "CHEBYSHEV", "MOMENTUM"};
+    if (std::find(supported_accelerations.begin(), supported_accelerations.end(), acceleration) == supported_accelerations.end()) {
+        std::cerr << "WARNING: Unsupported acceleration. Defaulting to NONE." << std::endl << std::flush;
+        acceleration = "NONE";
+    }
+    chebyshev_low = chebyshev_high = 0;
+    momentum = 0;
+    if (acceleration == "CHEBYSHEV") {
+        // Interval of the unwanted eigenvalues of A, estimated with an automatic shift if missing
+        std::vector<double> bounds;
+        try {
+            bounds = input.method_config.at("BOUNDS").get<std::vector<double>>();
+        }
+        catch (const std::exception &e) {
+            bounds.clear();
+        }
+        if (bounds.size() == 2 && bounds[0] < bounds[1]) {
+            chebyshev_low = bounds[0];
+            chebyshev_high = bounds[1];
+            has_bounds = true;
+        }
+    }
+    else if (acceleration == "MOMENTUM") {
+        momentum = getJsonValueOptional<double>(input.method_config, "BETA",
+            "WARNING: Missing momentum BETA. Defaulting to 0.", 0.0);
+    }
+}
+
+/**
+ * @brief Sets up the shift, the shifted operator and the Chebyshev interval.
+ * 
+ * An automatic shift is estimated first. The Chebyshev interval of the unwanted
+ * eigenvalues of A is then moved by the shift to those of @f$ A - \mu I @f$ and, for the
+ * inverse method, mapped to those of @f$ (A - \mu I)^{-1} @f$.
+ * @param inverse True for the inverse method.
+ */
+void PowerBasedSolver::configureShift(bool inverse)
+{
+    if (auto_shift) {
+        estimateShift(inverse);
+    }
+    shifted_op = std::make_shared<ShiftedOperator>(op, shift);
+    if (acceleration != "CHEBYSHEV") {
+        return;
+    }
+    if (!has_bounds) {
+        std::cerr << "WARNING: Missing or invalid BOUNDS for Chebyshev acceleration. Defaulting to NONE." << std::endl << std::flush;
+        acceleration = "NONE";
+        return;
+    }
+    if (shift.imag() != 0) {
+        std::cerr << "WARNING: Chebyshev acceleration needs a real shift. Defaulting to NONE." << std::endl << std::flush;
+        acceleration = "NONE";
+        return;
+    }
+    chebyshev_low -= shift.real();
+    chebyshev_high -= shift.real();
+    if (inverse) {
+        // The unwanted eigenvalues of the inverse lie between the inverses of the bounds
+        if (chebyshev_low * chebyshev_high <= 0) {
+            std::cerr << "WARNING: The shift lies inside the Chebyshev BOUNDS. Defaulting to NONE." << std::endl << std::flush;
+            acceleration = "NONE";
+            return;
+        }
+        double low = 1.0 / chebyshev_high;
+        chebyshev_high = 1.0 / chebyshev_low;
+        chebyshev_low = low;
+    }
+}
+
+/**
+ * @brief Chooses the shift from an estimate of the spectrum, before the iteration.
+ * 
+ * "AUTO_STEPS" steps of the Arnoldi process (Lanczos for Hermitian matrices) from a
+ * random vector give Ritz values @f$ \theta_k @f$, which approximate the extreme
+ * eigenvalues first, and residual bounds @f$ r_k = h_{m+1,m} |y_{mk}| @f$. For Hermitian
+ * matrices the enclosure @f$ [\theta_{min} - r_{min}, \theta_{max} + r_{max}] @f$ is clipped
+ * to the Gershgorin interval when the dense matrix is available, and:
+ * - the power method targets the end of the enclosure of largest magnitude, as with
+ *   shift 0, and takes the shift in the middle of the interval of the unwanted
+ *   eigenvalues, which minimizes the convergence ratio;
+ * - the inverse method targets the end closest to 0 when the enclosure does not contain
+ *   0, and takes the shift just outside of it, at a distance of the residual bound, but
+ *   at least 1% of the gap to the next Ritz value to keep the shifted matrix regular.
+ * 
+ * These intervals are also the Chebyshev BOUNDS when none are given. For other matrices,
+ * the power method targets the largest Ritz value in magnitude and takes the shift 0 or
+ * the center of the other Ritz values, whichever gives the smaller ratio; the inverse
+ * method shifts next to the smallest Ritz value in magnitude if it has converged. The
+ * predicted speedup is the ratio of the iterations predicted with shift 0 to those
+ * predicted with the chosen shift.
+ * @param inverse True for the inverse method.
+ */
+void PowerBasedSolver::estimateShift(bool inverse)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    hermitian = hermitian || (A.size() > 0 && isHermitian(A));
+
+    // Arnoldi process with full reorthogonalization
+    int m = std::min(n, auto_steps);
+    Eigen::MatrixXcd V(n, m + 1);
+    Eigen::MatrixXcd H = Eigen::MatrixXcd::Zero(m + 1, m);
+    Eigen::VectorXcd w(n);
+    V.col(0) = randomMatrix(n, 1).col(0).normalized();
+    int steps = m;
+    for (int j=0; j<m; j++) {
+        op->apply(V.col(j), w);
+        for (int pass=0; pass<2; pass++) {
+            Eigen::VectorXcd h = V.leftCols(j + 1).adjoint() * w;
+            w -= V.leftCols(j + 1) * h;
+            H.col(j).head(j + 1) += h;
+        }
+        H(j + 1, j) = w.norm();
+        if (std::abs(H(j + 1, j)) <= 1e-12 * H.topLeftCorner(j + 2, j + 1).norm()) {
+            // Invariant subspace, the Ritz values are eigenvalues
+            H(j + 1, j) = 0;
+            steps = j + 1;
+            break;
+        }
+        V.col(j + 1) = w / H(j + 1, j);
+    }
+    Eigen::ComplexEigenSolver<Eigen::MatrixXcd> ritz(H.topLeftCorner(steps, steps));
+    Eigen::VectorXcd theta = ritz.eigenvalues();
+    Eigen::VectorXd residual = std::abs(H(steps, steps - 1)) * ritz.eigenvectors().row(steps - 1).cwiseAbs().transpose();
+
+    // Convergence ratio of the target eigenvalue for a shift, from the Ritz values
+    double ratio_auto = 1, ratio_zero = 1;
+    std::ostringstream enclosure;
+    if (hermitian && steps > 1) {
+        std::vector<int> order(steps);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&theta](int a, int b) { return theta(a).real() < theta(b).real(); });
+        double theta_min = theta(order[0]).real(), theta_max = theta(order[steps - 1]).real();
+        double second_min = theta(order[1]).real(), second_max = theta(order[steps - 2]).real();
+        double low = theta_min - residual(order[0]), high = theta_max + residual(order[steps - 1]);
+        if (A.size() > 0) {
+            // Gershgorin discs of a Hermitian matrix enclose its real spectrum
+            Eigen::VectorXd radius = A.cwiseAbs().colwise().sum().transpose() - A.diagonal().cwiseAbs();
+            low = std::max(low, (A.diagonal().real() - radius).minCoeff());
+            high = std::min(high, (A.diagonal().real() + radius).maxCoeff());
+        }
+        enclosure << "[" << low << ", " << high << "]";
+        // Unwanted interval and shift for the top (or bottom) end of the spectrum
+        bool top;
+        double target, unwanted_low, unwanted_high;
+        if (!inverse) {
+            top = std::abs(high) >= std::abs(low);
+            target = top ? theta_max : theta_min;
+            unwanted_low = top ? low : std::max(second_min - residual(order[1]), theta_min);
+            unwanted_high = top ? std::min(second_max + residual(order[steps - 2]), theta_max) : high;
+            shift = (unwanted_low + unwanted_high) / 2;
+            auto ratio = [&](double mu) {
+                return std::max(std::abs(unwanted_low - mu), std::abs(unwanted_high - mu)) / std::abs(target - mu);
+            };
+            ratio_auto = ratio(shift.real());
+            ratio_zero = ratio(0);
+        }
+        else if (low > 0 || high < 0) {
+            top = high < 0;
+            target = top ? theta_max : theta_min;
+            double next = top ? second_max : second_min;
+            double margin = std::max(residual(order[top ? steps - 1 : 0]), 0.01 * std::abs(next - target));
+            shift = top ? target + margin : target - margin;
+            unwanted_low = top ? low : std::max(next - residual(order[1]), theta_min);
+            unwanted_high = top ? std::min(next + residual(order[steps - 2]), theta_max) : high;
+            auto ratio = [&](double mu) {
+                return std::abs(target - mu) / std::abs(next - mu);
+            };
+            ratio_auto = ratio(shift.real());
+            ratio_zero = ratio(0);
+        }
+        else {
+            std::cerr << "WARNING: The spectrum contains 0, no automatic shift for the inverse method. Defaulting to 0." << std::endl << std::flush;
+            unwanted_low = unwanted_high = 0;
+        }
+        if (acceleration == "CHEBYSHEV" && !has_bounds && unwanted_low < unwanted_high) {
+            chebyshev_low = unwanted_low;
+            chebyshev_high = unwanted_high;
+            has_bounds = true;
+        }
+    }
+    else if (steps > 1) {
+        double radius = (theta.cwiseAbs() + residual).maxCoeff();
+        if (A.size() > 0) {
+            Eigen::VectorXd disc = A.cwiseAbs().colwise().sum().transpose();
+            radius = std::min(radius, disc.maxCoeff());
+        }
+        enclosure << "|z| <= " << radius;
+        int target;
+        if (!inverse) {
+            theta.cwiseAbs().maxCoeff(&target);
+            auto ratio = [&](Eigen::dcomplex mu) {
+                double unwanted = 0;
+                for (int k=0; k<steps; k++) {
+                    if (k != target) {
+                        unwanted = std::max(unwanted, std::abs(theta(k) - mu) + residual(k));
+                    }
+                }
+                return unwanted / std::abs(theta(target) - mu);
+            };
+            // Center of the bounding box of the other Ritz values
+            Eigen::VectorXcd others(steps - 1);
+            for (int k=0, o=0; k<steps; k++) {
+                if (k != target) {
+                    others(o++) = theta(k);
+                }
+            }
+            Eigen::dcomplex center((others.real().minCoeff() + others.real().maxCoeff()) / 2,
+                (others.imag().minCoeff() + others.imag().maxCoeff()) / 2);
+            ratio_zero = ratio(0);
+            ratio_auto = ratio(center);
+            shift = ratio_auto < ratio_zero ? center : Eigen::dcomplex(0);
+            ratio_auto = std::min(ratio_auto, ratio_zero);
+        }
+        else {
+            theta.cwiseAbs().minCoeff(&target);
+            double gap = std::numeric_limits<double>::infinity();
+            for (int k=0; k<steps; k++) {
+                if (k != target) {
+                    gap = std::min(gap, std::abs(theta(k) - theta(target)));
+                }
+            }
+            if (residual(target) < 0.01 * gap) {
+                shift = theta(target) + std::max(residual(target), 0.01 * gap);
+                ratio_auto = std::abs(theta(target) - shift) / (gap - std::abs(theta(target) - shift));
+                ratio_zero = std::abs(theta(target)) / std::max(std::abs(theta(target)), gap - std::abs(theta(target)));
+            }
+            else {
+                std::cerr << "WARNING: No converged estimate of the smallest eigenvalue. Defaulting to 0." << std::endl << std::flush;
+            }
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    estimation_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+    spectrum_estimate = enclosure.str();
+    // Iterations to reduce the error by a fixed factor are proportional to 1 / |log(ratio)|
+    if (ratio_auto > 0 && ratio_auto < 1 && ratio_zero > 0 && ratio_zero < 1) {
+        predicted_speedup = std::to_string(std::log(ratio_auto) / std::log(ratio_zero));
+    }
+    else if (ratio_auto > 0 && ratio_auto < 1) {
+        predicted_speedup = "unbounded, shift 0 does not converge to the target";
+    }
+    else {
+        predicted_speedup = "1";
+    }
 }
 
 /**
@@ -45,17 +406,123 @@ PowerBasedSolver::PowerBasedSolver(InputData input) : Solver(input)
  * Initializes the power method solver using the provided input data.
  * @param input The input data of the problem contained in InputData struct.
  */
-PowerSolver::PowerSolver(InputData input) : PowerBasedSolver(input) {}
+PowerSolver::PowerSolver(InputData input) : PowerBasedSolver(std::move(input))
+{
+    configureShift(false);
+}
 
 /**
  * @brief InverseSolver constructor. Inherits from PowerBasedSolver.
  * 
- * Initializes the inverse power method solver and performs matrix decomposition.
+ * Initializes the inverse power method solver and factorizes the shifted matrix with
+ * the strategy given by "FACTORIZATION" in the method configuration.
  * @param input The input data of the problem contained in InputData struct.
  */
-InverseSolver::InverseSolver(InputData input) : PowerBasedSolver(input)
+InverseSolver::InverseSolver(InputData input) : PowerBasedSolver(std::move(input)), solve_time(0), num_solves(0)
+{
+    configureShift(true);
+
+    factorization_type = getJsonValueOptional<std::string>(input.method_config, "FACTORIZATION",
+        "WARNING: Missing factorization. Defaulting to AUTO.", "AUTO");
+
+    // Rayleigh quotient iteration, silently off if missing
+    rayleigh = input.method_config.value("RAYLEIGH", false);
+    refactor_every = input.method_config.value("REFACTOR_EVERY", 1);
+    std::string rayleigh_solve = input.method_config.value("RAYLEIGH_SOLVE", "FACTORIZE");
+    if (refactor_every < 1) {
+        std::cerr << "WARNING: Invalid REFACTOR_EVERY. Defaulting to 1." << std::endl << std::flush;
+        refactor_every = 1;
+    }
+    if (rayleigh_solve != "FACTORIZE" && rayleigh_solve != "HESSENBERG") {
+        std::cerr << "WARNING: Unsupported RAYLEIGH_SOLVE. Defaulting to FACTORIZE." << std::endl << std::flush;
+        rayleigh_solve = "FACTORIZE";
+    }
+    if (rayleigh && acceleration != "NONE") {
+        std::cerr << "WARNING: Acceleration is not supported with Rayleigh quotient iteration. Defaulting to NONE." << std::endl << std::flush;
+        acceleration = "NONE";
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    hessenberg = nullptr;
+    current_shift = shift;
+    if (rayleigh && rayleigh_solve == "HESSENBERG") {
+        requireDenseMatrix();
+        auto reduction = std::make_unique<HessenbergFactorization>();
+        reduction->compute(A);
+        hessenberg = reduction.get();
+        decomp = std::move(reduction);
+    }
+    factorization_time = 0;
+    refactorize(shift);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    factorization_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+}
+
+/**
+ * @brief Factorizes the matrix shifted by a new shift, and adds the time to the factorization time.
+ * 
+ * The fixed shift uses the "FACTORIZATION" strategy. The Rayleigh quotients converge to
+ * an eigenvalue, so the shifted matrix becomes numerically singular by design: it is
+ * factorized with partial pivoting LU, without falling back to the complete orthogonal
+ * decomposition, whose minimum norm solve would remove the wanted eigenvector. With the
+ * Hessenberg form only the shifted Hessenberg matrix is refactorized, in @f$ O(n^2) @f$.
+ * If the new shifted matrix is exactly singular, the previous factorization is kept.
+ * @param new_shift The shift.
+ */
+void InverseSolver::refactorize(Eigen::dcomplex new_shift)
 {
-    decomp = shifted_matrix.completeOrthogonalDecomposition();
+    auto start_time = std::chrono::high_resolution_clock::now();
+    if (hessenberg) {
+        if (hessenberg->setShift(new_shift)) {
+            current_shift = new_shift;
+        }
+        else {
+            hessenberg->setShift(current_shift);
+        }
+    }
+    else if (new_shift == shift) {
+        decomp = factorizeShifted(new_shift, factorization_type);
+        current_shift = new_shift;
+    }
+    else {
+        Eigen::VectorXcd diagonal = A.diagonal();
+        A.diagonal().array() -= new_shift;
+        auto lu = std::make_unique<LUFactorization>();
+        lu->compute(A);
+        A.diagonal() = diagonal;
+        decomp = std::move(lu);
+        current_shift = new_shift;
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    factorization_time += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+}
+
+/**
+ * @brief Rayleigh quotient iteration step, moves the shift to the Rayleigh quotient.
+ * 
+ * From the second convergence check on, the shift is replaced by the Rayleigh quotient
+ * every "REFACTOR_EVERY" checks. For Hermitian matrices the residual of Rayleigh quotient
+ * iteration decreases monotonically and converges cubically; as a safeguard, once the
+ * residual grows the fixed shift is restored and the solve continues as plain inverse
+ * iteration.
+ * @param quotient Rayleigh quotient of the current approximation.
+ * @param error Residual norm of the current approximation.
+ */
+void InverseSolver::updateShift(Eigen::dcomplex quotient, double error)
+{
+    if (!rayleigh || fallback) {
+        return;
+    }
+    if (num_checks > 1 && error > last_error) {
+        fallback = true;
+        refactorize(shift);
+        return;
+    }
+    last_error = error;
+    if (num_checks > 1 && num_checks % refactor_every == 0) {
+        refactorize(quotient);
+        shift_updates++;
+    }
 }
 
 /**
@@ -64,74 +531,235 @@ InverseSolver::InverseSolver(InputData input) : PowerBasedSolver(input)
  * Initializes the QR-based solver with the given input data.
  * @param input The input data of the problem contained in InputData struct.
  */
-QRSolver::QRSolver(InputData input) : Solver(input) {}
+QRSolver::QRSolver(InputData input) : Solver(std::move(input))
+{
+    requireDenseMatrix();
+}
+
+/**
+ * @brief ShiftedQRSolver constructor to initialize the shifted QR method solver.
+ * 
+ * Initializes the Hessenberg QR-based solver with the given input data.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+ShiftedQRSolver::ShiftedQRSolver(InputData input) : Solver(std::move(input))
+{
+    requireDenseMatrix();
+}
+
+/**
+ * @brief FrancisQRSolver constructor to initialize the double-shift QR method solver.
+ * 
+ * Keeps only the real part of the input matrix, the complex copy is released together
+ * with the operator viewing it.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+FrancisQRSolver::FrancisQRSolver(InputData input) : Solver(std::move(input))
+{
+    requireDenseMatrix();
+    A_real = A.real();
+    releaseMatrix();
+}
 
 /**
- * @brief Solves the eigenvalue problem using a power-based method.
+ * @brief Solves the eigenvalue problem with a power-based iteration.
+ * 
+ * Every iteration writes the next approximation into a preallocated workspace and
+ * normalizes it. Every "CHECK_EVERY" iterations, and at the last one, a single product
+ * @f$ A b @f$ gives the Rayleigh quotient and the residual, and is reused by the power
+ * method for its next step. The workspace is allocated before the loop. When an
+ * allocation counter is installed, the heap allocations of the whole loop on the calling
+ * thread, products and solves included, are reported as the "Loop Allocations" metric,
+ * which stays 0 for a stored matrix and a fixed shift.
  * 
- * Iterates for a maximum number of iterations to approximate the eigenvector
- * and calculate the eigenvalue using the Rayleigh quotient. Convergence is
- * measured based on the residual norm.
+ * With an acceleration, the step @f$ y \mapsto B y @f$ of the iteration operator B is
+ * replaced by:
+ * - CHEBYSHEV: the three-term recurrence @f$ y_{k+1} = 2 t(B) y_k - y_{k-1} @f$ of the
+ *   Chebyshev polynomials, started with @f$ y_1 = t(B) y_0 @f$ so that
+ *   @f$ y_k = T_k(t(B)) y_0 @f$, where t maps the interval of the unwanted eigenvalues
+ *   to [-1, 1], so that they are damped the most;
+ * - MOMENTUM: @f$ y_{k+1} = B y_k - \beta y_{k-1} @f$.
+ * 
+ * Both recurrences scale @f$ y_k @f$ and @f$ y_{k-1} @f$ by the same factor, which
+ * leaves the direction of the iterates unchanged. AITKEN extrapolates the Rayleigh
+ * quotients of three successive checks with the @f$ \Delta^2 @f$ process, and stops
+ * once two successive extrapolations agree within the tolerance. The estimated error
+ * stays the residual of the eigenvector, and the difference of the last two
+ * extrapolations is reported as the "Extrapolation Gap" metric.
  */
 void PowerBasedSolver::solve()
 {
     // Declare eigenvalue and error
-    Eigen::dcomplex eigenval;
-    Eigen::VectorXcd residual;
-    // Get random starting eigenvector
-    Eigen::VectorXcd b = Eigen::VectorXcd::Random(n);
+    Eigen::dcomplex eigenval = 0;
+    double error = 0;
+    // Workspace: get the warm start or a random starting eigenvector
+    Eigen::VectorXcd b = startingBlock(1);
+    Eigen::VectorXcd residual(n);
+    next.resize(n);
+    Ab.resize(n);
+    bool recurrence = (acceleration == "CHEBYSHEV" || acceleration == "MOMENTUM");
+    previous.resize(recurrence ? n : 0);
+    product_ready = false;
+    num_checks = 0;
+    // Rayleigh quotients of the last three checks and last extrapolation, for AITKEN
+    Eigen::dcomplex quotients[3];
+    Eigen::dcomplex extrapolated = 0;
+    double extrapolation_gap = std::numeric_limits<double>::infinity();
     
     auto start_time = std::chrono::high_resolution_clock::now();
+    AllocationCounter count_allocations = allocationCounter();
+    std::size_t allocations = count_allocations ? count_allocations() : 0;
     int i = 0;
     for (i; i<num_iters; i++)
     {
         // Approximation of eigenvector
-        Eigen::VectorXcd b_tmp = eigenvec_approx(b);
-        // Compute the norm
-        auto norm = b_tmp.norm();
-        // Update the eigenvector b
-        b = b_tmp / norm;
-        // Compute the eigenvalue via Rayleigh quotient
-        eigenval = Eigen::dcomplex(b.adjoint() * A * b) 
-                        / Eigen::dcomplex(b.adjoint() * b);
-
-        // Check for convergence
-        residual = A*b - eigenval*b;
-        if (residual.norm() < tol) {
+        eigenvec_approx(b, next);
+        if (acceleration == "CHEBYSHEV") {
+            // t(B) b, with t mapping [low, high] to [-1, 1]; y_1 = T_1(t(B)) y_0 is this alone
+            double center = (chebyshev_high + chebyshev_low) / 2;
+            double half_width = (chebyshev_high - chebyshev_low) / 2;
+            next = (next - center*b) / half_width;
+            if (i > 0) {
+                next = 2.0*next - previous;
+            }
+        }
+        else if (acceleration == "MOMENTUM" && i > 0) {
+            next -= momentum*previous;
+        }
+        // Update the eigenvector b, the product of the previous one is stale
+        double scale = next.norm();
+        if (recurrence) {
+            previous = b / scale;
+        }
+        b = next / scale;
+        product_ready = false;
+
+        // Compute the eigenvalue via Rayleigh quotient and check for convergence
+        bool converged = false;
+        if ((i + 1) % check_every == 0 || i + 1 == num_iters) {
+            op->apply(b, Ab);
+            product_ready = true;
+            eigenval = b.dot(Ab) / b.squaredNorm();
+            residual = Ab - eigenval*b;
+            error = residual.norm();
+            converged = error < tol;
+            num_checks++;
+
+            if (acceleration == "AITKEN") {
+                quotients[0] = quotients[1];
+                quotients[1] = quotients[2];
+                quotients[2] = eigenval;
+                if (num_checks >= 3) {
+                    Eigen::dcomplex denominator = quotients[2] - 2.0*quotients[1] + quotients[0];
+                    Eigen::dcomplex difference = quotients[2] - quotients[1];
+                    Eigen::dcomplex last = extrapolated;
+                    extrapolated = (denominator != 0.0) ? quotients[2] - difference*difference/denominator : quotients[2];
+                    if (num_checks >= 4) {
+                        extrapolation_gap = std::abs(extrapolated - last);
+                        if (!converged && extrapolation_gap < tol) {
+                            eigenval = extrapolated;
+                            converged = true;
+                        }
+                    }
+                }
+            }
+        }
+        if (converged) {
             break;
         }
+        if (product_ready) {
+            updateShift(eigenval, error);
+        }
+    }
+    if (count_allocations) {
+        allocations = count_allocations() - allocations;
     }
     auto end_time = std::chrono::high_resolution_clock::now();
     output.estimated_eigenvalues.resize(1);
     output.estimated_eigenvalues[0] = eigenval;
-    output.estimated_error = residual.norm();
+    output.estimated_eigenvectors = b;
+    output.estimated_error = error;
     output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
     output.iterations = i;
     output.method = method_name;
+    output.metrics.emplace_back("Convergence Checks", std::to_string(num_checks));
+    output.metrics.emplace_back("Loop Allocations", count_allocations ? std::to_string(allocations) : "unavailable");
+    if (acceleration != "NONE") {
+        output.metrics.emplace_back("Acceleration", acceleration);
+    }
+    if (acceleration == "AITKEN") {
+        output.metrics.emplace_back("Extrapolation Gap", std::to_string(extrapolation_gap));
+    }
+    if (auto_shift) {
+        output.metrics.emplace_back("Automatic Shift", std::to_string(shift.real()) + " + " + std::to_string(shift.imag()) + "i");
+        output.metrics.emplace_back("Spectrum Estimate", spectrum_estimate);
+        output.metrics.emplace_back("Shift Estimation Time", std::to_string(estimation_time) + " microseconds");
+        output.metrics.emplace_back("Predicted Speedup", predicted_speedup);
+    }
+    op->reportMetrics(output.metrics);
 }
 
 /**
  * @brief Performs eigenvector approximation for the power method.
  * 
- * Multiplies the shifted matrix with the current eigenvector approximation.
+ * Applies the shifted operator to the current eigenvector approximation. After a
+ * convergence check @f$ A b @f$ is already known from the Rayleigh quotient, and only
+ * the shift is applied.
  * @param b Current approximation of the eigenvector. Passed to the method as a const reference to 'Eigen::VectorXcd'.
- * @return Eigen::VectorXcd representing a step in approximating the eigenvector before normalization.
+ * @param b_next Output, the next approximation before normalization.
  */
-Eigen::VectorXcd PowerSolver::eigenvec_approx(Eigen::VectorXcd const& b)
+void PowerSolver::eigenvec_approx(Eigen::VectorXcd const& b, Eigen::VectorXcd & b_next)
 {
-    return shifted_matrix*b;
+    if (product_ready) {
+        b_next = Ab - shift*b;
+        return;
+    }
+    shifted_op->apply(b, b_next);
 }
 
 /**
  * @brief Performs eigenvector approximation for the inverse power method.
  * 
- * Uses matrix decomposition to solve the system and approximate the eigenvector.
+ * Uses the factorization of the shifted matrix to solve the system and approximate the
+ * eigenvector, writing the solution into the workspace.
  * @param b Current approximation of the eigenvector. Passed to the method as a const reference to 'Eigen::VectorXcd'.
- * @return Eigen::VectorXcd representing a step in approximating the eigenvector before normalization.
+ * @param b_next Output, the next approximation before normalization.
  */
-Eigen::VectorXcd InverseSolver::eigenvec_approx(Eigen::VectorXcd const& b)
+void InverseSolver::eigenvec_approx(Eigen::VectorXcd const& b, Eigen::VectorXcd & b_next)
 {
-    return decomp.solve(b);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    decomp->solveInto(b, b_next);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    solve_time += std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    num_solves++;
+}
+
+/**
+ * @brief Solves the eigenvalue problem with the inverse power method.
+ * 
+ * Runs the generic power-based iteration and reports the factorization used, the
+ * factorization time and the average time per solve separately.
+ */
+void InverseSolver::solve()
+{
+    solve_time = 0;
+    num_solves = 0;
+    shift_updates = 0;
+    fallback = false;
+    last_error = 0;
+    if (current_shift != shift) {
+        refactorize(shift);
+    }
+    PowerBasedSolver::solve();
+    output.metrics.emplace_back("Factorization", decomp->getName());
+    output.metrics.emplace_back("Factorization Time", std::to_string(factorization_time) + " microseconds");
+    output.metrics.emplace_back("Average Solve Time",
+        std::to_string(num_solves > 0 ? solve_time / num_solves : 0.0) + " microseconds");
+    if (rayleigh) {
+        output.metrics.emplace_back("Shift Updates", std::to_string(shift_updates));
+        output.metrics.emplace_back("Final Shift", std::to_string(current_shift.real()) + " + " + std::to_string(current_shift.imag()) + "i");
+        output.metrics.emplace_back("Rayleigh Fallback", fallback ? "yes" : "no");
+    }
 }
 
 /**
@@ -166,12 +794,1223 @@ void QRSolver::solve()
     output.method = "QR Method";
 }
 
+/**
+ * @brief Computes the Wilkinson shift of the trailing 2x2 block of the active window.
+ * 
+ * Returns the eigenvalue of the block closest to H(hi,hi), computed in a form
+ * that avoids cancellation.
+ * @param H Upper Hessenberg matrix.
+ * @param hi Last row/column of the active window.
+ * @return Eigen::dcomplex containing the shift.
+ */
+Eigen::dcomplex ShiftedQRSolver::wilkinsonShift(Eigen::MatrixXcd const& H, int hi)
+{
+    Eigen::dcomplex a = H(hi-1, hi-1);
+    Eigen::dcomplex bc = H(hi-1, hi) * H(hi, hi-1);
+    Eigen::dcomplex d = H(hi, hi);
+    Eigen::dcomplex p = 0.5 * (a - d);
+    Eigen::dcomplex disc = std::sqrt(p*p + bc);
+    // Pick the root with the larger denominator
+    Eigen::dcomplex denom = (std::abs(p + disc) >= std::abs(p - disc)) ? p + disc : p - disc;
+    if (std::abs(denom) == 0.0) {
+        return d;
+    }
+    return d - bc / denom;
+}
+
+/**
+ * @brief Performs one implicit single-shift QR step on the active window.
+ * 
+ * The first Givens rotation is determined by the shifted first column and
+ * introduces a bulge below the subdiagonal, which is then chased down to the
+ * bottom of the window. Only the rows and columns of the window are updated,
+ * so a step costs O((hi-lo)^2).
+ * @param H Upper Hessenberg matrix, modified in place.
+ * @param lo First row/column of the active window.
+ * @param hi Last row/column of the active window.
+ * @param shift Shift used for the step.
+ */
+void ShiftedQRSolver::qrStep(Eigen::MatrixXcd & H, int lo, int hi, Eigen::dcomplex shift)
+{
+    Eigen::JacobiRotation<Eigen::dcomplex> rot;
+    rot.makeGivens(H(lo, lo) - shift, H(lo+1, lo));
+    H.middleCols(lo, hi-lo+1).applyOnTheLeft(lo, lo+1, rot.adjoint());
+    H.middleRows(lo, std::min(lo+2, hi)-lo+1).applyOnTheRight(lo, lo+1, rot);
+
+    // Chase the bulge down the subdiagonal
+    for (int i = lo+1; i < hi; i++) {
+        rot.makeGivens(H(i, i-1), H(i+1, i-1), &H(i, i-1));
+        H(i+1, i-1) = 0.0;
+        H.middleCols(i, hi-i+1).applyOnTheLeft(i, i+1, rot.adjoint());
+        H.middleRows(lo, std::min(i+2, hi)-lo+1).applyOnTheRight(i, i+1, rot);
+    }
+}
+
+/**
+ * @brief Find all eigenvalues using the shifted QR method on the Hessenberg form.
+ * 
+ * Reduces the matrix to upper Hessenberg form and iterates implicit Wilkinson-shifted
+ * QR steps on the active window, deflating from the bottom whenever a subdiagonal
+ * entry falls below the tolerance. An exceptional shift is used every 10 iterations
+ * without deflation to break cycles.
+ */
+void ShiftedQRSolver::solve()
+{
+    int cnt = 0;
+    int iters_since_deflation = 0;
+    double eps = std::numeric_limits<double>::epsilon();
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Eigen::MatrixXcd H = Eigen::HessenbergDecomposition<Eigen::MatrixXcd>(A).matrixH();
+
+    // A subdiagonal entry is negligible below tol or at machine precision relative to its neighbours
+    auto negligible = [&](int k) {
+        double sub = std::abs(H(k, k-1));
+        return sub < tol || sub <= eps * (std::abs(H(k, k)) + std::abs(H(k-1, k-1)));
+    };
+
+    int hi = n - 1;
+    while (hi > 0 && cnt < num_iters) {
+        // Deflate a converged eigenvalue at the bottom of the window
+        if (negligible(hi)) {
+            hi--;
+            iters_since_deflation = 0;
+            continue;
+        }
+        // Find the top of the unreduced active window
+        int lo = hi - 1;
+        while (lo > 0 && !negligible(lo)) {
+            lo--;
+        }
+
+        Eigen::dcomplex shift;
+        if (iters_since_deflation > 0 && iters_since_deflation % 10 == 0) {
+            // Exceptional shift, taken from EISPACK comqr
+            shift = std::abs(H(hi, hi-1).real()) + (hi > 1 ? std::abs(H(hi-1, hi-2).real()) : 0.0);
+        }
+        else {
+            shift = wilkinsonShift(H, hi);
+        }
+        qrStep(H, lo, hi, shift);
+        cnt++;
+        iters_since_deflation++;
+    }
+
+    // error calculation (sub_diagonal norm)
+    double err = H.diagonal(-1).norm();
+    auto end_time = std::chrono::high_resolution_clock::now();
+    output.estimated_eigenvalues = H.diagonal();
+    output.estimated_error = err;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = cnt;
+    output.method = "Shifted QR Method";
+}
+
+/**
+ * @brief HermitianSolver constructor to initialize the divide-and-conquer solver.
+ * 
+ * Reads the number of threads from the method configuration. A value of zero
+ * uses the hardware concurrency.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+HermitianSolver::HermitianSolver(InputData input) : Solver(std::move(input)), num_merges(0)
+{
+    requireDenseMatrix();
+    num_threads = getJsonValueOptional<int>(input.method_config, "THREADS",
+        "WARNING: Missing number of threads. Defaulting to hardware concurrency.", 0);
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+/**
+ * @brief ArnoldiSolver constructor to initialize the implicitly restarted Arnoldi solver.
+ * 
+ * Reads the number of wanted eigenvalues, the Krylov subspace size and the wanted part
+ * of the spectrum from the method configuration.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+ArnoldiSolver::ArnoldiSolver(InputData input) : Solver(std::move(input))
+{
+    k = getJsonValueOptional<int>(input.method_config, "K",
+        "WARNING: Missing number of eigenvalues. Defaulting to 10.", 10);
+    m = getJsonValueOptional<int>(input.method_config, "KRYLOV_SIZE",
+        "WARNING: Missing Krylov subspace size. Defaulting to max(2K+1, 20).", 0);
+    which = getJsonValueOptional<std::string>(input.method_config, "WHICH",
+        "WARNING: Missing wanted eigenvalues. Defaulting to largest magnitude.", "LM");
+
+    if (which != "LM" && which != "LR" && which != "SR") {
+        std::cerr << "WARNING: Unsupported wanted eigenvalues. Defaulting to largest magnitude." << std::endl << std::flush;
+        which = "LM";
+    }
+    if (k < 1 || k > n) {
+        std::cerr << "WARNING: Invalid number of eigenvalues. Defaulting to " << std::min(10, n) << "." << std::endl << std::flush;
+        k = std::min(10, n);
+    }
+    if (m <= k) {
+        m = std::max(2*k + 1, 20);
+    }
+    m = std::min(m, n);
+}
+
+/**
+ * @brief SubspaceSolver constructor to initialize the block subspace iteration.
+ * 
+ * Reads the block size, the shift and the inverse flag from the method configuration.
+ * The inverse variant decomposes the shifted matrix once.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+SubspaceSolver::SubspaceSolver(InputData input) : Solver(std::move(input))
+{
+    k = getJsonValueOptional<int>(input.method_config, "K",
+        "WARNING: Missing number of eigenvalues. Defaulting to 4.", 4);
+    shift = 0;
+    if (input.method_config.contains("SHIFT")) {
+        shift = parseComplexValue(input.method_config["SHIFT"]);
+    }
+    else {
+        std::cerr << "WARNING: Missing shift. Defaulting to 0." << std::endl << std::flush;
+    }
+    inverse = getJsonValueOptional<bool>(input.method_config, "INVERSE",
+        "WARNING: Missing inverse flag. Defaulting to false.", false);
+
+    if (k < 1 || k > n) {
+        std::cerr << "WARNING: Invalid number of eigenvalues. Defaulting to " << std::min(4, n) << "." << std::endl << std::flush;
+        k = std::min(4, n);
+    }
+    factorization_time = 0;
+    if (inverse) {
+        std::string type = getJsonValueOptional<std::string>(input.method_config, "FACTORIZATION",
+            "WARNING: Missing factorization. Defaulting to AUTO.", "AUTO");
+        auto start_time = std::chrono::high_resolution_clock::now();
+        decomp = factorizeShifted(shift, type);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        factorization_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    }
+}
+
+/**
+ * @brief Performs one implicit Francis double-shift step on the active window.
+ * 
+ * The shifts are the two eigenvalues of the trailing 2x2 block, passed through
+ * their sum and product so that the step stays in real arithmetic. A 3x3 Householder
+ * reflector creates a bulge which is chased to the bottom of the window.
+ * @param H Upper Hessenberg matrix, modified in place.
+ * @param lo First row/column of the active window.
+ * @param hi Last row/column of the active window.
+ * @param s Sum of the two shifts.
+ * @param t Product of the two shifts.
+ */
+void FrancisQRSolver::francisStep(Eigen::MatrixXd & H, int lo, int hi, double s, double t)
+{
+    Eigen::VectorXd workspace(n);
+    double tau, beta;
+
+    // First column of (H - s1 I)(H - s2 I)
+    Eigen::Vector3d v;
+    v(0) = H(lo, lo)*H(lo, lo) + H(lo, lo+1)*H(lo+1, lo) - s*H(lo, lo) + t;
+    v(1) = H(lo+1, lo) * (H(lo, lo) + H(lo+1, lo+1) - s);
+    v(2) = H(lo+1, lo) * H(lo+2, lo+1);
+
+    for (int k = lo; k <= hi-2; k++) {
+        if (k > lo) {
+            v = H.block<3,1>(k, k-1);
+        }
+        Eigen::Vector2d ess;
+        v.makeHouseholder(ess, tau, beta);
+        if (beta != 0.0) {
+            if (k > lo) {
+                H(k, k-1) = beta;
+                H(k+1, k-1) = 0.0;
+                H(k+2, k-1) = 0.0;
+            }
+            H.block(k, k, 3, hi-k+1).applyHouseholderOnTheLeft(ess, tau, workspace.data());
+            H.block(lo, k, std::min(hi, k+3)-lo+1, 3).applyHouseholderOnTheRight(ess, tau, workspace.data());
+        }
+    }
+
+    Eigen::Vector2d w = H.block<2,1>(hi-1, hi-2);
+    Eigen::Matrix<double, 1, 1> ess;
+    w.makeHouseholder(ess, tau, beta);
+    if (beta != 0.0) {
+        H(hi-1, hi-2) = beta;
+        H(hi, hi-2) = 0.0;
+        H.block(hi-1, hi-1, 2, 2).applyHouseholderOnTheLeft(ess, tau, workspace.data());
+        H.block(lo, hi-1, hi-lo+1, 2).applyHouseholderOnTheRight(ess, tau, workspace.data());
+    }
+}
+
+/**
+ * @brief Find all eigenvalues of a real matrix using the Francis double-shift QR method.
+ * 
+ * Reduces the matrix to upper Hessenberg form and iterates double-shift steps on
+ * the active window. Converged 1x1 blocks give real eigenvalues, converged 2x2
+ * blocks give either two real eigenvalues or a complex conjugate pair.
+ */
+void FrancisQRSolver::solve()
+{
+    int cnt = 0;
+    int iters_since_deflation = 0;
+    double eps = std::numeric_limits<double>::epsilon();
+    double err = 0;
+    Eigen::VectorXcd eigenvals(n);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Eigen::MatrixXd H = Eigen::HessenbergDecomposition<Eigen::MatrixXd>(A_real).matrixH();
+
+    auto negligible = [&](int k) {
+        double sub = std::abs(H(k, k-1));
+        return sub < tol || sub <= eps * (std::abs(H(k, k)) + std::abs(H(k-1, k-1)));
+    };
+
+    int hi = n - 1;
+    while (hi >= 0) {
+        int lo = hi;
+        while (lo > 0 && !negligible(lo)) {
+            lo--;
+        }
+        if (lo == hi || lo == hi - 1) {
+            // Converged block, accumulate the negligible entry above it into the error
+            if (lo > 0) {
+                err += H(lo, lo-1) * H(lo, lo-1);
+            }
+            if (lo == hi) {
+                eigenvals(hi) = H(hi, hi);
+            }
+            else {
+                double a = H(hi-1, hi-1), bc = H(hi-1, hi)*H(hi, hi-1), d = H(hi, hi);
+                double p = 0.5 * (a - d);
+                double q = p*p + bc;
+                if (q >= 0) {
+                    double z = p + std::copysign(std::sqrt(q), p);
+                    eigenvals(hi-1) = d + z;
+                    eigenvals(hi) = (z != 0.0) ? d - bc / z : d + z;
+                }
+                else {
+                    eigenvals(hi-1) = Eigen::dcomplex(d + p, std::sqrt(-q));
+                    eigenvals(hi) = Eigen::dcomplex(d + p, -std::sqrt(-q));
+                }
+            }
+            hi = lo - 1;
+            iters_since_deflation = 0;
+            continue;
+        }
+        if (cnt >= num_iters) {
+            // Not converged, report the remaining diagonal as estimates
+            err += H.diagonal(-1).segment(lo, hi-lo).squaredNorm();
+            eigenvals.segment(lo, hi-lo+1) = H.diagonal().segment(lo, hi-lo+1);
+            hi = lo - 1;
+            continue;
+        }
+
+        double s, t;
+        if (iters_since_deflation > 0 && iters_since_deflation % 10 == 0) {
+            // Exceptional shift, taken from EISPACK hqr
+            double e = std::abs(H(hi, hi-1)) + std::abs(H(hi-1, hi-2));
+            s = 1.5 * e;
+            t = e * e;
+        }
+        else {
+            s = H(hi-1, hi-1) + H(hi, hi);
+            t = H(hi-1, hi-1)*H(hi, hi) - H(hi-1, hi)*H(hi, hi-1);
+        }
+        francisStep(H, lo, hi, s, t);
+        cnt++;
+        iters_since_deflation++;
+    }
+    err = std::sqrt(err);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    output.estimated_eigenvalues = eigenvals;
+    output.estimated_error = err;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = cnt;
+    output.method = "Francis Double-Shift QR Method";
+}
+
+/**
+ * @brief Recursively solves a symmetric tridiagonal eigenproblem.
+ * 
+ * The tridiagonal matrix is split in two halves through a rank-one tearing of the
+ * middle subdiagonal entry. The halves are solved recursively, on separate threads
+ * while the depth allows it, and merged by solving the secular equation. Small
+ * problems are solved directly with the implicit QL method of Eigen.
+ * @param d Diagonal of the tridiagonal matrix.
+ * @param e Subdiagonal of the tridiagonal matrix.
+ * @param eigenvals Output eigenvalues in ascending order.
+ * @param eigenvecs Output eigenvectors, stored column-wise.
+ * @param depth Current recursion depth, used to limit the number of threads.
+ */
+void HermitianSolver::divideAndConquer(Eigen::VectorXd const& d, Eigen::VectorXd const& e,
+    Eigen::VectorXd & eigenvals, Eigen::MatrixXd & eigenvecs, int depth)
+{
+    const int leaf_size = 32;
+    int m = d.size();
+    if (m <= leaf_size) {
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> leaf;
+        leaf.computeFromTridiagonal(d, e, Eigen::ComputeEigenvectors);
+        eigenvals = leaf.eigenvalues();
+        eigenvecs = leaf.eigenvectors();
+        return;
+    }
+
+    // Tear the matrix at the middle subdiagonal entry
+    int k = m / 2;
+    double beta = e(k-1);
+    Eigen::VectorXd d1 = d.head(k), d2 = d.tail(m-k);
+    d1(k-1) -= beta;
+    d2(0) -= beta;
+    Eigen::VectorXd e1 = e.head(k-1), e2 = e.tail(m-k-1);
+
+    Eigen::VectorXd l1, l2;
+    Eigen::MatrixXd Q1, Q2;
+    if ((1 << depth) < num_threads) {
+        auto upper = std::async(std::launch::async, [&]() { divideAndConquer(d1, e1, l1, Q1, depth+1); });
+        divideAndConquer(d2, e2, l2, Q2, depth+1);
+        upper.get();
+    }
+    else {
+        divideAndConquer(d1, e1, l1, Q1, depth+1);
+        divideAndConquer(d2, e2, l2, Q2, depth+1);
+    }
+
+    Eigen::VectorXd D(m), z(m);
+    D << l1, l2;
+    z << Q1.row(k-1).transpose(), Q2.row(0).transpose();
+    Eigen::MatrixXd Q = Eigen::MatrixXd::Zero(m, m);
+    Q.topLeftCorner(k, k) = Q1;
+    Q.bottomRightCorner(m-k, m-k) = Q2;
+    Q1.resize(0, 0);
+    Q2.resize(0, 0);
+    mergeRankOne(D, z, beta, std::move(Q), eigenvals, eigenvecs);
+    num_merges++;
+}
+
+/**
+ * @brief Computes the eigendecomposition of @f$ Q (D + \rho z z^T) Q^T @f$.
+ * 
+ * Components of z that are negligible, and pairs of nearly equal diagonal entries,
+ * are deflated first. The remaining eigenvalues are the roots of the secular equation
+ * @f$ 1 + \rho \sum_j z_j^2 / (d_j - \lambda) = 0 @f$, found by safeguarded Newton
+ * iterations relative to the closest pole. The eigenvectors are computed from the
+ * Gu-Eisenstat corrected z so that they stay numerically orthogonal.
+ * @param D Diagonal entries.
+ * @param z Rank-one update vector.
+ * @param rho Rank-one update weight.
+ * @param Q Orthogonal matrix of the merged subproblems.
+ * @param eigenvals Output eigenvalues in ascending order.
+ * @param eigenvecs Output eigenvectors, stored column-wise.
+ */
+void HermitianSolver::mergeRankOne(Eigen::VectorXd D, Eigen::VectorXd z, double rho, Eigen::MatrixXd Q,
+    Eigen::VectorXd & eigenvals, Eigen::MatrixXd & eigenvecs)
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    int m = D.size();
+
+    // Work with rho > 0, negating the problem if needed
+    double sign = (rho < 0) ? -1.0 : 1.0;
+    D *= sign;
+    rho *= sign;
+
+    // Sort the diagonal in ascending order
+    std::vector<int> perm(m);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&](int a, int b) { return D(a) < D(b); });
+    Eigen::VectorXd d_sorted(m), z_sorted(m);
+    Eigen::MatrixXd Q_sorted(m, m);
+    for (int i = 0; i < m; i++) {
+        d_sorted(i) = D(perm[i]);
+        z_sorted(i) = z(perm[i]);
+        Q_sorted.col(i) = Q.col(perm[i]);
+    }
+    Q.resize(0, 0);
+    double z_norm = z_sorted.norm();
+    if (z_norm > 0) {
+        z_sorted /= z_norm;
+        rho *= z_norm * z_norm;
+    }
+
+    // Deflation
+    double defl_tol = 8.0 * eps * std::max(d_sorted.cwiseAbs().maxCoeff(), rho);
+    std::vector<int> keep;
+    for (int i = 0; i < m; i++) {
+        if (rho * std::abs(z_sorted(i)) <= defl_tol) {
+            continue;
+        }
+        if (!keep.empty()) {
+            int j = keep.back();
+            double tau = std::hypot(z_sorted(j), z_sorted(i));
+            double c = z_sorted(i) / tau;
+            double s = z_sorted(j) / tau;
+            if (std::abs((d_sorted(i) - d_sorted(j)) * c * s) <= defl_tol) {
+                // Rotate the weight of z_j onto z_i, column j is then an eigenvector
+                Eigen::VectorXd q_j = Q_sorted.col(j);
+                Q_sorted.col(j) = c * q_j - s * Q_sorted.col(i);
+                Q_sorted.col(i) = s * q_j + c * Q_sorted.col(i);
+                double d_j = d_sorted(j);
+                d_sorted(j) = c*c * d_j + s*s * d_sorted(i);
+                d_sorted(i) = s*s * d_j + c*c * d_sorted(i);
+                z_sorted(j) = 0.0;
+                z_sorted(i) = tau;
+                keep.pop_back();
+            }
+        }
+        keep.push_back(i);
+    }
+
+    std::vector<bool> is_kept(m, false);
+    for (int i : keep) {
+        is_kept[i] = true;
+    }
+    int K = keep.size();
+    Eigen::VectorXd dk(K), zk(K);
+    for (int a = 0; a < K; a++) {
+        dk(a) = d_sorted(keep[a]);
+        zk(a) = z_sorted(keep[a]);
+    }
+
+    // Solve the secular equation, each root is stored relative to its closest pole
+    Eigen::VectorXd lambda(K);
+    Eigen::MatrixXd delta(K, K); // delta(a,b) = dk(a) - lambda(b)
+    for (int i = 0; i < K; i++) {
+        int origin = i;
+        double lo_t, hi_t;
+        if (i < K-1) {
+            double mid = 0.5 * (dk(i+1) - dk(i));
+            double f_mid = 1.0;
+            for (int j = 0; j < K; j++) {
+                f_mid += rho * zk(j)*zk(j) / ((dk(j) - dk(i)) - mid);
+            }
+            if (f_mid >= 0) {
+                lo_t = 0.0;
+                hi_t = mid;
+            }
+            else {
+                origin = i+1;
+                lo_t = -mid;
+                hi_t = 0.0;
+            }
+        }
+        else {
+            lo_t = 0.0;
+            hi_t = rho * zk.squaredNorm();
+        }
+
+        double tau = 0.5 * (lo_t + hi_t);
+        for (int it = 0; it < 100; it++) {
+            double psi = 0, dpsi = 0, abs_psi = 0;
+            for (int j = 0; j < K; j++) {
+                double t = zk(j) / ((dk(j) - dk(origin)) - tau);
+                psi += zk(j) * t;
+                dpsi += t * t;
+                abs_psi += std::abs(zk(j) * t);
+            }
+            double f = 1.0 + rho * psi;
+            if (std::abs(f) <= K * eps * (1.0 + rho * abs_psi)) {
+                break;
+            }
+            if (f < 0) {
+                lo_t = tau;
+            }
+            else {
+                hi_t = tau;
+            }
+            double tau_new = tau - f / (rho * dpsi);
+            if (!(tau_new > lo_t && tau_new < hi_t)) {
+                tau_new = 0.5 * (lo_t + hi_t);
+            }
+            if (std::abs(tau_new - tau) <= eps * std::abs(tau)) {
+                tau = tau_new;
+                break;
+            }
+            tau = tau_new;
+        }
+        lambda(i) = dk(origin) + tau;
+        for (int a = 0; a < K; a++) {
+            delta(a, i) = (dk(a) - dk(origin)) - tau;
+        }
+    }
+
+    // Gu-Eisenstat correction of z and eigenvectors of the rank-one problem
+    Eigen::MatrixXd U(K, K);
+    for (int a = 0; a < K; a++) {
+        double prod = -delta(a, a);
+        for (int b = 0; b < K; b++) {
+            if (b != a) {
+                prod *= -delta(a, b) / (dk(b) - dk(a));
+            }
+        }
+        double z_hat = std::copysign(std::sqrt(std::max(prod, 0.0) / rho), zk(a));
+        U.row(a) = z_hat * delta.row(a).cwiseInverse();
+    }
+    U.colwise().normalize();
+
+    // Assemble the merged eigenpairs
+    Eigen::MatrixXd Q_kept(m, K);
+    for (int a = 0; a < K; a++) {
+        Q_kept.col(a) = Q_sorted.col(keep[a]);
+    }
+    Eigen::MatrixXd QU = Q_kept * U;
+    Q_kept.resize(0, 0);
+
+    std::vector<int> source(m);
+    Eigen::VectorXd all_vals(m);
+    all_vals.head(K) = lambda;
+    std::iota(source.begin(), source.begin() + K, 0);
+    int pos = K;
+    for (int i = 0; i < m; i++) {
+        if (!is_kept[i]) {
+            all_vals(pos) = d_sorted(i);
+            source[pos] = i;
+            pos++;
+        }
+    }
+    all_vals *= sign;
+
+    std::vector<int> order(m);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return all_vals(a) < all_vals(b); });
+    eigenvals.resize(m);
+    eigenvecs.resize(m, m);
+    for (int i = 0; i < m; i++) {
+        eigenvals(i) = all_vals(order[i]);
+        if (order[i] < K) {
+            eigenvecs.col(i) = QU.col(order[i]);
+        }
+        else {
+            eigenvecs.col(i) = Q_sorted.col(source[order[i]]);
+        }
+    }
+}
+
+/**
+ * @brief Find all eigenvalues of a Hermitian matrix.
+ * 
+ * Reduces the matrix to real symmetric tridiagonal form and solves it with the
+ * divide-and-conquer method. The error is the largest residual norm of the computed
+ * eigenpairs of the tridiagonal matrix.
+ */
+void HermitianSolver::solve()
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    num_merges = 0;
+
+    Eigen::Tridiagonalization<Eigen::MatrixXcd> tridiag(A);
+    Eigen::VectorXd d = tridiag.diagonal();
+    Eigen::VectorXd e = tridiag.subDiagonal();
+
+    Eigen::VectorXd eigenvals;
+    Eigen::MatrixXd eigenvecs;
+    divideAndConquer(d, e, eigenvals, eigenvecs, 0);
+
+    // Residuals T q - lambda q, computed in O(n^2) using the tridiagonal structure
+    Eigen::MatrixXd R = d.asDiagonal() * eigenvecs;
+    if (n > 1) {
+        R.topRows(n-1) += e.asDiagonal() * eigenvecs.bottomRows(n-1);
+        R.bottomRows(n-1) += e.asDiagonal() * eigenvecs.topRows(n-1);
+    }
+    R -= eigenvecs * eigenvals.asDiagonal();
+    double err = R.colwise().norm().maxCoeff();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    output.estimated_eigenvalues = eigenvals.cast<Eigen::dcomplex>();
+    output.estimated_error = err;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = num_merges;
+    output.method = "Hermitian Divide-and-Conquer Method";
+}
+
+/**
+ * @brief CirculantSolver constructor.
+ * 
+ * Keeps the circulant operator of the input, the matrix is never formed.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+CirculantSolver::CirculantSolver(InputData input) : Solver(std::move(input))
+{
+    circulant = std::dynamic_pointer_cast<const ToeplitzOperator>(op);
+    if (!circulant || !circulant->isCirculant()) {
+        throw ConfigError("The circulant solver needs a circulant operator.");
+    }
+}
+
+/**
+ * @brief Find all eigenvalues of a circulant matrix.
+ * 
+ * The eigenvalues are the DFT of the first column. The error is the largest residual
+ * of the first two eigenpairs, whose Fourier eigenvectors are built explicitly and
+ * multiplied with the FFT-based product.
+ */
+void CirculantSolver::solve()
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Eigen::VectorXcd eigenvals = circulant->circulantEigenvalues();
+
+    double err = 0;
+    Eigen::VectorXcd v(n), Av(n);
+    for (int k=0; k<std::min(n, 2); k++) {
+        for (int j=0; j<n; j++) {
+            v(j) = std::polar(1.0 / std::sqrt(n), 2 * M_PI * ((static_cast<long>(j) * k) % n) / n);
+        }
+        op->apply(v, Av);
+        err = std::max(err, (Av - eigenvals(k) * v).norm());
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    output.estimated_eigenvalues = eigenvals;
+    output.estimated_error = err;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = 1;
+    output.method = "Circulant FFT Method";
+}
+
+/**
+ * @brief Extends the Arnoldi factorization from j0 to m vectors.
+ * 
+ * Each new vector is orthogonalized twice against the basis (classical Gram-Schmidt
+ * with reorthogonalization). On breakdown the subdiagonal entry is set to zero and
+ * the basis is continued with a random vector orthogonal to it.
+ * @param j0 Current size of the factorization.
+ */
+void ArnoldiSolver::extendFactorization(int j0)
+{
+    Eigen::VectorXcd w(n);
+    for (int j = j0; j < m; j++) {
+        op->apply(V.col(j), w);
+        double w_norm = w.norm();
+        Eigen::VectorXcd h = V.leftCols(j+1).adjoint() * w;
+        w.noalias() -= V.leftCols(j+1) * h;
+        Eigen::VectorXcd h2 = V.leftCols(j+1).adjoint() * w;
+        w.noalias() -= V.leftCols(j+1) * h2;
+        h += h2;
+
+        H.col(j).head(j+1) = h;
+        double beta = w.norm();
+        if (beta > std::numeric_limits<double>::epsilon() * w_norm && beta > 0.0) {
+            H(j+1, j) = beta;
+            V.col(j+1) = w / beta;
+        }
+        else {
+            // Invariant subspace found, restart the basis with a new direction
+            H(j+1, j) = 0.0;
+            V.col(j+1).setZero();
+            if (j+1 < n) {
+                w = randomMatrix(n, 1);
+                w -= V.leftCols(j+1) * (V.leftCols(j+1).adjoint() * w);
+                w -= V.leftCols(j+1) * (V.leftCols(j+1).adjoint() * w);
+                V.col(j+1) = w.normalized();
+            }
+        }
+    }
+}
+
+/**
+ * @brief Orders Ritz values from most to least wanted.
+ * 
+ * "LM" sorts by decreasing magnitude, "LR" by decreasing real part and "SR" by
+ * increasing real part.
+ * @param ritz_vals Ritz values to sort.
+ * @return Indices of the Ritz values in order of preference.
+ */
+std::vector<int> ArnoldiSolver::sortRitzValues(Eigen::VectorXcd const& ritz_vals)
+{
+    std::vector<int> order(ritz_vals.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (which == "LR") {
+            return ritz_vals(a).real() > ritz_vals(b).real();
+        }
+        if (which == "SR") {
+            return ritz_vals(a).real() < ritz_vals(b).real();
+        }
+        return std::abs(ritz_vals(a)) > std::abs(ritz_vals(b));
+    });
+    return order;
+}
+
+/**
+ * @brief Find the k wanted eigenvalues using the implicitly restarted Arnoldi method.
+ * 
+ * After each Arnoldi cycle the Ritz values are computed from the small Hessenberg
+ * matrix. A Ritz value is converged when its residual norm, which is given by the
+ * last component of its Ritz vector, is below the tolerance. Otherwise the
+ * factorization is compressed by implicit QR steps with the unwanted Ritz values as
+ * shifts, keeping the wanted part and some buffer vectors, and extended again.
+ * As in ARPACK, every converged wanted Ritz value keeps one more vector in the next
+ * cycle, up to half of the shifts, so that the converged ones are not damped by the
+ * restart while the others keep converging. Each cycle costs O(m n^2) for the
+ * matrix-vector products.
+ */
+void ArnoldiSolver::solve()
+{
+    int restarts = 0;
+    int keep = std::min(k + (m - k) / 2, m - 1);
+    Eigen::VectorXcd wanted_vals(k);
+    double err = 0;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    V = Eigen::MatrixXcd::Zero(n, m+1);
+    H = Eigen::MatrixXcd::Zero(m+1, m);
+    V.col(0) = startingBlock(1).col(0).normalized();
+
+    int j0 = 0;
+    while (true) {
+        extendFactorization(j0);
+
+        // Ritz values and residual norms
+        Eigen::MatrixXcd Hm = H.topLeftCorner(m, m);
+        Eigen::ComplexEigenSolver<Eigen::MatrixXcd> ritz(Hm);
+        std::vector<int> order = sortRitzValues(ritz.eigenvalues());
+        double beta = std::abs(H(m, m-1));
+        err = 0;
+        int converged = 0;
+        for (int i = 0; i < k; i++) {
+            wanted_vals(i) = ritz.eigenvalues()(order[i]);
+            double residual = beta * std::abs(ritz.eigenvectors()(m-1, order[i]));
+            converged += (residual < tol);
+            err = std::max(err, residual);
+        }
+        if (err < tol || restarts >= num_iters || m == n) {
+            break;
+        }
+
+        // Implicit restart with the unwanted Ritz values as exact shifts, keeping the converged ones
+        int kept = keep + std::min(converged, (m - keep) / 2);
+        Eigen::MatrixXcd Q = Eigen::MatrixXcd::Identity(m, m);
+        for (int i = kept; i < m; i++) {
+            Eigen::dcomplex shift = ritz.eigenvalues()(order[i]);
+            Eigen::HouseholderQR<Eigen::MatrixXcd> qr(Hm - shift * Eigen::MatrixXcd::Identity(m, m));
+            Eigen::MatrixXcd Qi = qr.householderQ();
+            Hm = Qi.adjoint() * Hm * Qi;
+            Q = Q * Qi;
+            // Remove round-off below the subdiagonal
+            for (int col = 0; col < m; col++) {
+                for (int row = col+2; row < m; row++) {
+                    Hm(row, col) = 0.0;
+                }
+            }
+        }
+
+        // Compress the factorization to the first kept vectors
+        Eigen::VectorXcd f = V.leftCols(m) * Q.col(kept) * Hm(kept, kept-1)
+            + V.col(m) * H(m, m-1) * Q(m-1, kept-1);
+        V.leftCols(kept) = V.leftCols(m) * Q.leftCols(kept);
+        H.setZero();
+        H.topLeftCorner(kept, kept) = Hm.topLeftCorner(kept, kept);
+        double f_norm = f.norm();
+        H(kept, kept-1) = f_norm;
+        if (f_norm > 0.0) {
+            V.col(kept) = f / f_norm;
+        }
+        else {
+            V.col(kept) = randomMatrix(n, 1);
+            V.col(kept) -= V.leftCols(kept) * (V.leftCols(kept).adjoint() * V.col(kept));
+            V.col(kept).normalize();
+        }
+        j0 = kept;
+        restarts++;
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    output.estimated_eigenvalues = wanted_vals;
+    output.estimated_error = err;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = restarts;
+    output.method = "Implicitly Restarted Arnoldi Method";
+    op->reportMetrics(output.metrics);
+}
+
+/**
+ * @brief Find k eigenvalues with block subspace iteration.
+ * 
+ * Each step applies the shifted operator (one matrix-matrix product) or its inverse
+ * (one solve with a block right-hand side) to the active block, projects out the
+ * locked vectors and re-orthonormalizes with QR. The Rayleigh-Ritz projection
+ * @f$ Q^H A Q @f$ gives the Ritz values, ordered by distance to the shift (farthest
+ * first for the power variant, closest first for the inverse one). In the power
+ * variant the product @f$ A X @f$ of the Rayleigh-Ritz step is reused for the next
+ * iteration, so only one product with A is needed per step. Leading Ritz pairs whose
+ * residual is below the tolerance are locked.
+ */
+void SubspaceSolver::solve()
+{
+    int locked = 0;
+    int it = 0;
+    Eigen::VectorXcd eigenvals(k);
+    Eigen::VectorXd res_norms = Eigen::VectorXd::Zero(k);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    // Orthonormal starting block and its image
+    Eigen::MatrixXcd X = Eigen::HouseholderQR<Eigen::MatrixXcd>(startingBlock(k)).householderQ()
+        * Eigen::MatrixXcd::Identity(n, k);
+    Eigen::MatrixXcd AX(n, k);
+    op->applyBlock(X, AX);
+    Eigen::MatrixXcd Y(n, k), AQ(n, k);
+
+    for (it = 0; it < num_iters && locked < k; it++) {
+        int active = k - locked;
+        auto Xa = X.rightCols(active);
+        auto Xl = X.leftCols(locked);
+        auto Ya = Y.rightCols(active);
+        auto AQa = AQ.rightCols(active);
+
+        // Block step
+        if (inverse) {
+            Ya = decomp->solve(Xa);
+        }
+        else {
+            Ya = AX.rightCols(active) - shift * Xa;
+        }
+
+        // Deflate the locked vectors and re-orthonormalize
+        if (locked > 0) {
+            Ya -= Xl * (Xl.adjoint() * Ya);
+            Ya -= Xl * (Xl.adjoint() * Ya);
+        }
+        Eigen::MatrixXcd Q = Eigen::HouseholderQR<Eigen::MatrixXcd>(Ya).householderQ()
+            * Eigen::MatrixXcd::Identity(n, active);
+
+        // Rayleigh-Ritz projection on the active block
+        op->applyBlock(Q, AQa);
+        Eigen::MatrixXcd H = Q.adjoint() * AQa;
+        Eigen::ComplexEigenSolver<Eigen::MatrixXcd> ritz(H);
+        std::vector<int> order(active);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            double dist_a = std::abs(ritz.eigenvalues()(a) - shift);
+            double dist_b = std::abs(ritz.eigenvalues()(b) - shift);
+            return inverse ? dist_a < dist_b : dist_a > dist_b;
+        });
+        Eigen::MatrixXcd W(active, active);
+        for (int j = 0; j < active; j++) {
+            W.col(j) = ritz.eigenvectors().col(order[j]);
+            eigenvals(locked + j) = ritz.eigenvalues()(order[j]);
+        }
+        Xa.noalias() = Q * W;
+        AX.rightCols(active).noalias() = AQa * W;
+
+        // Residuals, projected on the complement of the locked invariant subspace
+        Eigen::MatrixXcd R = AX.rightCols(active) - Xa * eigenvals.tail(active).asDiagonal();
+        if (locked > 0) {
+            R -= Xl * (Xl.adjoint() * R);
+        }
+        res_norms.tail(active) = R.colwise().norm().transpose();
+
+        // Lock leading converged vectors, keeping the locked basis orthonormal
+        while (locked < k && res_norms(locked) < tol) {
+            Eigen::VectorXcd x = X.col(locked);
+            x -= X.leftCols(locked) * (X.leftCols(locked).adjoint() * x);
+            X.col(locked) = x.normalized();
+            locked++;
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    output.estimated_eigenvalues = eigenvals;
+    output.estimated_eigenvectors = X;
+    output.estimated_error = res_norms.maxCoeff();
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = it;
+    output.method = inverse ? "Inverse Block Subspace Iteration" : "Block Subspace Iteration";
+    if (inverse) {
+        output.metrics.emplace_back("Factorization", decomp->getName());
+        output.metrics.emplace_back("Factorization Time", std::to_string(factorization_time) + " microseconds");
+    }
+    op->reportMetrics(output.metrics);
+}
+
+/**
+ * @brief MultiShiftSolver constructor.
+ * 
+ * Collects the shifts from "SHIFTS", a list of complex numbers, and from "SHIFT_GRID",
+ * a rectangular grid given by {"REAL": [min, max, steps], "IMAG": [min, max, steps]}.
+ * @param input The input data of the problem contained in InputData struct.
+ */
+MultiShiftSolver::MultiShiftSolver(InputData input) : Solver(std::move(input))
+{
+    requireDenseMatrix();
+    json const& config = input.method_config;
+
+    if (config.contains("SHIFTS")) {
+        if (!config["SHIFTS"].is_array()) {
+            throw ConfigError("SHIFTS must be a list of complex numbers.");
+        }
+        for (auto const& s : config["SHIFTS"]) {
+            shifts.push_back(parseComplexValue(s));
+        }
+    }
+    if (config.contains("SHIFT_GRID")) {
+        json const& grid = config["SHIFT_GRID"];
+        auto axis = [&grid](std::string const& key) {
+            json range = grid.contains(key) ? grid[key] : json::array({0.0, 0.0, 1});
+            if (!range.is_array() || range.size() != 3 || range[2].get<int>() < 1) {
+                throw ConfigError("SHIFT_GRID " + key + " must be [min, max, steps] with at least one step.");
+            }
+            int steps = range[2].get<int>();
+            double lo = range[0].get<double>(), hi = range[1].get<double>();
+            std::vector<double> values(steps);
+            for (int i=0; i<steps; i++) {
+                values[i] = steps == 1 ? lo : lo + (hi - lo) * i / (steps - 1);
+            }
+            return values;
+        };
+        for (double im : axis("IMAG")) {
+            for (double re : axis("REAL")) {
+                shifts.emplace_back(re, im);
+            }
+        }
+    }
+    if (shifts.empty()) {
+        throw ConfigError("Multi-shift inverse iteration needs at least one shift.");
+    }
+
+    num_threads = getJsonValueOptional<int>(config, "THREADS",
+        "WARNING: Missing number of threads. Defaulting to hardware concurrency.", 0);
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::min<int>(num_threads, shifts.size());
+    factorization_type = getJsonValueOptional<std::string>(config, "FACTORIZATION",
+        "WARNING: Missing factorization. Defaulting to AUTO.", "AUTO");
+    merge_tol = getJsonValueOptional<double>(config, "MERGE_TOL",
+        "WARNING: Missing merge tolerance. Defaulting to 1e-6.", 1e-6);
+}
+
+/**
+ * @brief Runs inverse iteration with a single shift.
+ * 
+ * Only reads the shared input matrix, so it can run concurrently for different shifts.
+ * The random starting vector is drawn from a generator seeded per shift, since the
+ * solver's own generator cannot be shared between the worker threads.
+ * @param shift The shift @f$ \mu @f$.
+ * @param shift_seed Seed of the random starting vector.
+ * @return ShiftResult with the eigenvalue closest to the shift.
+ */
+MultiShiftSolver::ShiftResult MultiShiftSolver::inverseIteration(Eigen::dcomplex shift, unsigned int shift_seed) const
+{
+    std::unique_ptr<Factorization> decomp = createFactorization(A - shift*Eigen::MatrixXcd::Identity(n,n), factorization_type);
+
+    std::mt19937 gen(shift_seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Eigen::VectorXcd b(n), Ab(n), residual(n);
+    for (int j=0; j<n; j++) {
+        b(j) = Eigen::dcomplex(dist(gen), dist(gen));
+    }
+
+    ShiftResult result{Eigen::dcomplex(0.0, 0.0), std::numeric_limits<double>::infinity(), 0};
+    for (int i=0; i<num_iters; i++) {
+        b = decomp->solve(b);
+        b.normalize();
+        op->apply(b, Ab);
+        result.eigenval = b.dot(Ab);
+        residual = Ab - result.eigenval*b;
+        result.residual = residual.norm();
+        result.iterations = i + 1;
+        if (result.residual < tol) {
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Runs inverse iteration for every shift and merges the eigenvalues found.
+ * 
+ * The worker threads take the next unprocessed shift until all shifts are done. Only
+ * converged eigenpairs are reported, unless no shift converged. Two eigenvalues are
+ * considered equal when @f$ |\lambda_i - \lambda_j| \le tol_{merge} \max(1, |\lambda_i|) @f$,
+ * in which case the one with the smaller residual is kept.
+ */
+void MultiShiftSolver::solve()
+{
+    int num_shifts = shifts.size();
+    std::vector<ShiftResult> results(num_shifts);
+    std::atomic<int> next(0);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto worker = [&]() {
+        for (int j = next++; j < num_shifts; j = next++) {
+            results[j] = inverseIteration(shifts[j], seed + j);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t=1; t<num_threads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto & w : workers) {
+        w.join();
+    }
+
+    // Merge duplicate eigenvalues, in the order of the shifts
+    int total_iters = 0, converged = 0;
+    for (auto const& r : results) {
+        total_iters += r.iterations;
+        converged += r.residual < tol;
+    }
+    std::vector<ShiftResult> distinct;
+    for (auto const& r : results) {
+        if (converged > 0 && !(r.residual < tol)) {
+            continue;
+        }
+        auto same = std::find_if(distinct.begin(), distinct.end(), [&](ShiftResult const& d) {
+            return std::abs(d.eigenval - r.eigenval) <= merge_tol * std::max(1.0, std::abs(d.eigenval));
+        });
+        if (same == distinct.end()) {
+            distinct.push_back(r);
+        }
+        else if (r.residual < same->residual) {
+            *same = r;
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    if (converged < num_shifts) {
+        std::cerr << "WARNING: " << num_shifts - converged << " of " << num_shifts
+            << " shifts did not converge." << std::endl << std::flush;
+    }
+
+    output.estimated_eigenvalues.resize(distinct.size());
+    output.estimated_error = 0;
+    for (int i=0; i<(int)distinct.size(); i++) {
+        output.estimated_eigenvalues[i] = distinct[i].eigenval;
+        output.estimated_error = std::max(output.estimated_error, distinct[i].residual);
+    }
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = total_iters;
+    output.method = "Multi-Shift Inverse Power Method";
+    output.metrics.emplace_back("Shifts", std::to_string(num_shifts));
+    output.metrics.emplace_back("Converged Shifts", std::to_string(converged));
+    output.metrics.emplace_back("Distinct Eigenvalues", std::to_string(distinct.size()));
+    output.metrics.emplace_back("Threads", std::to_string(num_threads));
+}
+
+/**
+ * @brief MultiResolutionSolver constructor.
+ * 
+ * Takes the coarse levels out of the input and keeps the rest as the input of the
+ * finest level, taking back the matrix the base constructor moved into A, together
+ * with its operator. The metrics of the input are already in the output.
+ * @param input The input data of the problem, with its coarse levels.
+ */
+MultiResolutionSolver::MultiResolutionSolver(InputData input) : Solver(std::move(input))
+{
+    levels = std::move(input.coarse_levels);
+    input.coarse_levels.clear();
+    finest = std::move(input);
+    finest.input_matrix = releaseMatrix();
+    // Metrics of the input, the start of the metrics of every solve
+    finest.metrics = output.metrics;
+}
+
+/**
+ * @brief Interpolates vectors linearly to a finer size.
+ * 
+ * Entries are treated as samples at the centers of equal cells, as the pixels of the
+ * downsampled image they come from.
+ * @param V Vectors to interpolate, one per column.
+ * @param size Number of rows of the result.
+ * @return 'Eigen::MatrixXcd' with the interpolated vectors, normalized.
+ */
+Eigen::MatrixXcd MultiResolutionSolver::upsample(Eigen::MatrixXcd const& V, int size)
+{
+    int m = V.rows();
+    Eigen::MatrixXcd U(size, V.cols());
+    for (int i=0; i<size; i++) {
+        double pos = std::clamp((i + 0.5) * m / size - 0.5, 0.0, m - 1.0);
+        int lo = static_cast<int>(pos);
+        int hi = std::min(lo + 1, m - 1);
+        double frac = pos - lo;
+        U.row(i) = (1 - frac) * V.row(lo) + frac * V.row(hi);
+    }
+    U.colwise().normalize();
+    return U;
+}
+
+/**
+ * @brief Solves every level with the method of the input, warm started from the previous one.
+ * 
+ * Every level reports its iterations, time and error as a metric. The eigenvalues,
+ * error and iterations of the output are those of the finest level, the execution time
+ * covers all levels. The matrices of the levels are moved into their solvers instead of
+ * copied, and taken back once a level is solved, so the solver can be solved again.
+ */
+void MultiResolutionSolver::solve()
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    Eigen::MatrixXcd warm_start;
+    OutputData level_output;
+    std::vector<std::pair<std::string, std::string>> metrics = finest.metrics;
+    for (std::size_t l=0; l<=levels.size(); l++) {
+        Eigen::MatrixXcd & M = (l < levels.size()) ? levels[l] : finest.input_matrix;
+        int size = M.rows();
+        InputData level_input;
+        level_input.method = finest.method;
+        level_input.num_iters = finest.num_iters;
+        level_input.tol = finest.tol;
+        level_input.method_config = finest.method_config;
+        level_input.seed = finest.seed;
+        level_input.hermitian = finest.hermitian;
+        level_input.size = size;
+        level_input.input_matrix = std::move(M);
+        if (warm_start.size() > 0) {
+            level_input.initial_vectors = upsample(warm_start, size);
+        }
+
+        std::unique_ptr<Solver> solver;
+        if (finest.method == "SUBSPACE") {
+            solver = std::make_unique<SubspaceSolver>(std::move(level_input));
+        }
+        else {
+            solver = std::make_unique<PowerSolver>(std::move(level_input));
+        }
+        solver->solve();
+        level_output = solver->getOutput();
+        warm_start = level_output.estimated_eigenvectors;
+        M = solver->releaseMatrix();
+
+        std::string side = std::to_string(size);
+        metrics.emplace_back("Level " + std::to_string(l + 1) + " (" + side + "x" + side + ")",
+            std::to_string(level_output.iterations) + " iterations, "
+            + std::to_string(level_output.execution_time) + " microseconds, error "
+            + std::to_string(level_output.estimated_error));
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    output.estimated_eigenvalues = level_output.estimated_eigenvalues;
+    output.estimated_eigenvectors = level_output.estimated_eigenvectors;
+    output.estimated_error = level_output.estimated_error;
+    output.execution_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+    output.iterations = level_output.iterations;
+    output.method = "Multi-Resolution " + level_output.method;
+    metrics.insert(metrics.end(), level_output.metrics.begin(), level_output.metrics.end());
+    output.metrics = std::move(metrics);
+}
+
 /**
  * @brief Returns the output data collected during the solving process.
  * 
  * Provides the estimated eigenvalues, error, execution time, iterations, and method used.
+ * The eigenvectors x of a balanced matrix @f$ D^{-1} A D @f$ are mapped back to the
+ * eigenvectors @f$ D x @f$ of the input matrix, normalized. The estimated error is left
+ * as the solver measured it, for the balanced matrix.
  * @return OutputData struct containing the results.
  */
 OutputData Solver::getOutput() {
-    return output;
-}
\ No newline at end of file
+    if (scaling.size() == 0 || output.estimated_eigenvectors.rows() != scaling.size()) {
+        return output;
+    }
+    OutputData result = output;
+    result.estimated_eigenvectors = scaling.asDiagonal() * output.estimated_eigenvectors;
+    result.estimated_eigenvectors.colwise().normalize();
+    return result;
+}
+/**
+ * @brief Moves the input matrix out of the solver.
+ *
+ * The operator may view the matrix, so it is released with it.
+ * @return The input matrix, empty if the solver no longer holds it.
+ */
+Eigen::MatrixXcd Solver::releaseMatrix() {
+    op.reset();
+    return std::move(A);
+}
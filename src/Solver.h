@@ -3,7 +3,14 @@
 
 #include "InputData.h"
 #include "OutputData.h"
+#include "LinearOperator.h"
+#include "Factorization.h"
+#include "ToeplitzOperator.h"
 #include <Eigen/Dense>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
 
 /** @file Solver.h
  * @brief Header file for all Solver based classes.
@@ -21,15 +28,47 @@ class Solver
         int n; /// Dimension of input matrix
         int num_iters; /// Maximum number of iterations for method
         double tol; /// Tolerance for measuring convergence
-        Eigen::MatrixXcd A; /// Input matrix
+        Eigen::MatrixXcd A; /// Input matrix, empty when the input is only given as an operator
+        std::shared_ptr<LinearOperator> op; /// Operator view of the input matrix, a DenseOperator referencing A for dense inputs
         OutputData output; /// Struct for data gathered during solving
         std::string method_name; /// Name of method used
+        unsigned int seed; /// Seed of the random number generator
+        std::mt19937 rng; /// Random number generator owned by the solver
+        Eigen::MatrixXcd initial_vectors; /// Warm start vectors given with the input, may be empty
+        Eigen::VectorXd scaling; /// Diagonal of the balancing similarity, empty if the input was not balanced
+        /**
+         * @brief Materializes the dense input matrix for methods that need access to its entries.
+         */
+        void requireDenseMatrix();
+        /**
+         * @brief Factorizes the shifted matrix @f$ A - \mu I @f$ without building a shifted copy.
+         * @param shift The shift @f$ \mu @f$.
+         * @param type Factorization strategy, see createFactorization.
+         * @return Pointer to the computed factorization.
+         */
+        std::unique_ptr<Factorization> factorizeShifted(Eigen::dcomplex shift, std::string const& type);
+        /**
+         * @brief Random matrix with real and imaginary parts uniform in [-1, 1].
+         * @param rows Number of rows.
+         * @param cols Number of columns.
+         * @return 'Eigen::MatrixXcd' drawn from the solver's own generator.
+         */
+        Eigen::MatrixXcd randomMatrix(int rows, int cols);
+        /**
+         * @brief Starting block for the iterative methods.
+         * @param cols Number of vectors.
+         * @return The warm start vectors of the input, completed with random vectors.
+         */
+        Eigen::MatrixXcd startingBlock(int cols);
     public:
         /**
          * @brief Abstract Solver constructor
-         * @param input The input data of the problem to initialize protected attributes.
+         * @param input The input data of the problem, its matrix and operator are moved out.
          */
-        Solver(InputData input);
+        Solver(InputData && input);
+        /// Not copyable nor movable: the operator of a dense input references the member A
+        Solver(Solver const&) = delete;
+        Solver & operator=(Solver const&) = delete;
         /// Abstract destructor
         virtual ~Solver() {};
         /**
@@ -37,6 +76,15 @@ class Solver
          * @return Struct containing information about a solver's run
          */
         OutputData getOutput();
+        /**
+         * @brief Gives the storage of the input matrix back, so that the caller can reuse it.
+         *
+         * The operator viewing the matrix is released with it, so the solver cannot solve
+         * again afterwards. The contents are unspecified, and the matrix is empty if the
+         * solver already released it.
+         * @return The input matrix, moved out of the solver.
+         */
+        Eigen::MatrixXcd releaseMatrix();
         /**
          * @brief Pure virtual function for running a solver
          * @return void: Alter OutputData object.
@@ -53,20 +101,59 @@ class Solver
 class PowerBasedSolver : public Solver
 {
     protected:
-        /// Shifted matrix given by: @f$ A - \mu I @f$ 
-        Eigen::MatrixXcd shifted_matrix;
+        /// Shift @f$ \mu @f$
+        Eigen::dcomplex shift;
+        /// Shifted operator given by: @f$ A - \mu I @f$, applied implicitly
+        std::shared_ptr<LinearOperator> shifted_op;
+        /// Product @f$ A b @f$ of the current approximation, computed for the Rayleigh quotient
+        Eigen::VectorXcd Ab;
+        /// True once Ab holds the product of the approximation passed to eigenvec_approx
+        bool product_ready;
+        /// Workspace for the next approximation before normalization
+        Eigen::VectorXcd next;
+        int check_every; /// Iterations between two convergence checks
+        int num_checks; /// Number of convergence checks of the last solve
+        std::string acceleration; /// "NONE", "AITKEN", "CHEBYSHEV" or "MOMENTUM"
+        double chebyshev_low; /// Lower bound of the unwanted eigenvalues of the iteration operator
+        double chebyshev_high; /// Upper bound of the unwanted eigenvalues of the iteration operator
+        double momentum; /// Momentum coefficient @f$ \beta @f$
+        /// Workspace for the previous approximation, used by the Chebyshev and momentum recurrences
+        Eigen::VectorXcd previous;
+        bool has_bounds; /// True once the Chebyshev interval is known
+        bool auto_shift; /// True if the shift is estimated from the spectrum
+        bool hermitian; /// True if the input is known to be Hermitian
+        int auto_steps; /// Arnoldi steps of the shift estimation
+        double estimation_time; /// Time spent estimating the shift, in microseconds
+        std::string spectrum_estimate; /// Enclosure of the spectrum found by the shift estimation
+        std::string predicted_speedup; /// Predicted iterations with shift 0 over those with the automatic shift
+        /**
+         * @brief Sets up the shift, the shifted operator and the Chebyshev interval, called by the derived constructors.
+         * @param inverse True for the inverse method.
+         */
+        void configureShift(bool inverse);
+        /**
+         * @brief Chooses the shift from Ritz values of a few Arnoldi steps.
+         * @param inverse True for the inverse method.
+         */
+        void estimateShift(bool inverse);
         /**
          * @brief Pure virtual function for eigenvector approximations. 
          * @param b Current approximation of the eigenvector. Passed to the method as a const reference to 'Eigen::VectorXcd'.
-         * @return 'Eigen::VectorXcd' representing a step in approximating the eigenvector before normalization.
+         * @param b_next Output, a step in approximating the eigenvector before normalization, preallocated.
          */
-        virtual Eigen::VectorXcd eigenvec_approx(Eigen::VectorXcd const& b) = 0;
+        virtual void eigenvec_approx(Eigen::VectorXcd const& b, Eigen::VectorXcd & b_next) = 0;
+        /**
+         * @brief Called after every convergence check that did not converge, does nothing by default.
+         * @param quotient Rayleigh quotient of the current approximation.
+         * @param error Residual norm of the current approximation.
+         */
+        virtual void updateShift(Eigen::dcomplex /*quotient*/, double /*error*/) {}
     public:
         /**
         * @brief Base constructor for any PowerBased derived class.
-        * @param input The input data of the problem contained in InputData struct.
+        * @param input The input data of the problem, its matrix and operator are moved out.
         */
-        PowerBasedSolver(InputData input); 
+        PowerBasedSolver(InputData && input); 
         /// Abstract destructor
         virtual ~PowerBasedSolver() {};
         /**
@@ -95,8 +182,10 @@ class PowerSolver : public PowerBasedSolver
         ~PowerSolver() {};
         /**
          * @brief Power method implementation of eigenvector approximation at each iteration. 
+         * Reuses the product computed for the Rayleigh quotient, so that each iteration
+         * makes a single pass over the operator.
          */
-        Eigen::VectorXcd eigenvec_approx(Eigen::VectorXcd const& b) override;
+        void eigenvec_approx(Eigen::VectorXcd const& b, Eigen::VectorXcd & b_next) override;
 };
 
 /**
@@ -108,8 +197,29 @@ class PowerSolver : public PowerBasedSolver
 class InverseSolver : public PowerBasedSolver
 {
     protected:
-        /// Matrix decomposition
-        Eigen::CompleteOrthogonalDecomposition<Eigen::MatrixXcd> decomp;
+        /// Factorization of the shifted matrix
+        std::unique_ptr<Factorization> decomp;
+        double factorization_time; /// Time spent factorizing, in microseconds
+        double solve_time; /// Total time spent in solves, in microseconds
+        int num_solves; /// Number of solves performed
+        std::string factorization_type; /// Factorization strategy, see createFactorization
+        bool rayleigh; /// True to update the shift with the Rayleigh quotient
+        int refactor_every; /// Convergence checks between two shift updates
+        /// decomp when the shift updates use the Hessenberg form, nullptr otherwise
+        HessenbergFactorization * hessenberg;
+        Eigen::dcomplex current_shift; /// Shift of the current factorization
+        double last_error; /// Residual norm at the previous convergence check
+        int shift_updates; /// Number of shift updates of the last solve
+        bool fallback; /// True once the safeguard went back to the fixed shift
+        /**
+         * @brief Factorizes the matrix shifted by a new shift.
+         * @param new_shift The shift.
+         */
+        void refactorize(Eigen::dcomplex new_shift);
+        /**
+         * @brief Rayleigh quotient iteration, updates the shift from the Rayleigh quotient.
+         */
+        void updateShift(Eigen::dcomplex quotient, double error) override;
     public:
         /**
          * @brief InverseSolver constructor
@@ -121,7 +231,11 @@ class InverseSolver : public PowerBasedSolver
         /**
          * @brief Inverse power method implementation of eigenvector approximation at each iteration.
          */
-        Eigen::VectorXcd eigenvec_approx(Eigen::VectorXcd const& b) override;
+        void eigenvec_approx(Eigen::VectorXcd const& b, Eigen::VectorXcd & b_next) override;
+        /**
+         * @brief Overriden solve method, adds the factorization and solve timings to the output.
+         */
+        void solve() override;
 };
 
 /**
@@ -145,5 +259,323 @@ class QRSolver : public Solver
         void solve() override;
 };
 
+/**
+ * @class ShiftedQRSolver
+ * @brief Derived Solver class that finds the eigenvalues using the shifted QR Method
+ * on the Hessenberg form of the input matrix.
+ *
+ * The matrix is reduced to upper Hessenberg form once. Each iteration then performs
+ * an implicit single-shift QR step (bulge chasing with Givens rotations) in O(n^2)
+ * using a Wilkinson shift, and the active window shrinks whenever a subdiagonal
+ * entry falls below the tolerance.
+ */
+class ShiftedQRSolver : public Solver
+{
+    protected:
+        /**
+         * @brief Performs one implicit single-shift QR step on the active window.
+         * @param H Upper Hessenberg matrix, modified in place.
+         * @param lo First row/column of the active window.
+         * @param hi Last row/column of the active window.
+         * @param shift Shift used for the step.
+         */
+        void qrStep(Eigen::MatrixXcd & H, int lo, int hi, Eigen::dcomplex shift);
+        /**
+         * @brief Computes the Wilkinson shift of the trailing 2x2 block of the active window.
+         * @param H Upper Hessenberg matrix.
+         * @param hi Last row/column of the active window.
+         * @return Eigenvalue of the trailing 2x2 block closest to H(hi,hi).
+         */
+        Eigen::dcomplex wilkinsonShift(Eigen::MatrixXcd const& H, int hi);
+    public:
+        /**
+        * @brief Constructs a ShiftedQRSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        ShiftedQRSolver(InputData input);
+        /// ShiftedQRSolver destructor
+        ~ShiftedQRSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Solves for the eigenvalues using the Hessenberg shifted QR method.
+        */
+        void solve() override;
+};
+
+/**
+ * @class FrancisQRSolver
+ * @brief Derived Solver class that finds the eigenvalues of a real matrix using the
+ * Francis double-shift QR Method.
+ *
+ * The computation is carried out entirely in real arithmetic on the upper Hessenberg
+ * form of the matrix. Complex conjugate eigenvalue pairs are recovered from the 2x2
+ * diagonal blocks of the converged quasi-triangular matrix.
+ */
+class FrancisQRSolver : public Solver
+{
+    protected:
+        /// Real part of the input matrix, the imaginary part is assumed to be zero
+        Eigen::MatrixXd A_real;
+        /**
+         * @brief Performs one implicit Francis double-shift step on the active window.
+         * @param H Upper Hessenberg matrix, modified in place.
+         * @param lo First row/column of the active window.
+         * @param hi Last row/column of the active window.
+         * @param s Sum of the two shifts.
+         * @param t Product of the two shifts.
+         */
+        void francisStep(Eigen::MatrixXd & H, int lo, int hi, double s, double t);
+    public:
+        /**
+        * @brief Constructs a FrancisQRSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        FrancisQRSolver(InputData input);
+        /// FrancisQRSolver destructor
+        ~FrancisQRSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Solves for the eigenvalues using the Francis double-shift QR method.
+        */
+        void solve() override;
+};
+
+/**
+ * @class HermitianSolver
+ * @brief Derived Solver class that finds all eigenvalues of a Hermitian matrix.
+ *
+ * The matrix is reduced to a real symmetric tridiagonal matrix, which is then solved
+ * with Cuppen's divide-and-conquer method. The two independent halves of every split
+ * are solved concurrently until the available threads are used up.
+ */
+class HermitianSolver : public Solver
+{
+    protected:
+        /// Number of threads used for independent subproblems
+        int num_threads;
+        /// Number of rank-one merges performed
+        std::atomic<int> num_merges;
+        /**
+         * @brief Recursively solves a symmetric tridiagonal eigenproblem.
+         * @param d Diagonal of the tridiagonal matrix.
+         * @param e Subdiagonal of the tridiagonal matrix.
+         * @param eigenvals Output eigenvalues in ascending order.
+         * @param eigenvecs Output eigenvectors, stored column-wise.
+         * @param depth Current recursion depth, used to limit the number of threads.
+         */
+        void divideAndConquer(Eigen::VectorXd const& d, Eigen::VectorXd const& e,
+            Eigen::VectorXd & eigenvals, Eigen::MatrixXd & eigenvecs, int depth);
+        /**
+         * @brief Computes the eigendecomposition of @f$ Q (D + \rho z z^T) Q^T @f$.
+         * @param D Diagonal entries.
+         * @param z Rank-one update vector.
+         * @param rho Rank-one update weight.
+         * @param Q Orthogonal matrix of the merged subproblems.
+         * @param eigenvals Output eigenvalues in ascending order.
+         * @param eigenvecs Output eigenvectors, stored column-wise.
+         */
+        void mergeRankOne(Eigen::VectorXd D, Eigen::VectorXd z, double rho, Eigen::MatrixXd Q,
+            Eigen::VectorXd & eigenvals, Eigen::MatrixXd & eigenvecs);
+    public:
+        /**
+        * @brief Constructs a HermitianSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        HermitianSolver(InputData input);
+        /// HermitianSolver destructor
+        ~HermitianSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Solves for the eigenvalues using tridiagonalization and divide-and-conquer.
+        */
+        void solve() override;
+};
+
+/**
+ * @class CirculantSolver
+ * @brief Derived Solver class that finds all eigenvalues of a circulant matrix by FFT.
+ *
+ * The eigenvectors of a circulant matrix are the Fourier vectors, so its eigenvalues
+ * are the discrete Fourier transform of its first column, computed in O(n log n)
+ * without forming the matrix.
+ */
+class CirculantSolver : public Solver
+{
+    protected:
+        /// Circulant operator of the input
+        std::shared_ptr<const ToeplitzOperator> circulant;
+    public:
+        /**
+        * @brief Constructs a CirculantSolver object.
+        * @param input The input data of the problem, its operator must be a circulant ToeplitzOperator.
+        */
+        CirculantSolver(InputData input);
+        /// CirculantSolver destructor
+        ~CirculantSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Computes the eigenvalues as the FFT of the first column.
+        */
+        void solve() override;
+};
+
+/**
+ * @class ArnoldiSolver
+ * @brief Derived Solver class that finds a few eigenvalues using the implicitly
+ * restarted Arnoldi method.
+ *
+ * Builds a Krylov subspace of fixed size with the Arnoldi process and compresses it
+ * after each cycle with implicit QR steps, using the unwanted Ritz values as exact
+ * shifts. The matrix is only accessed through matrix-vector products.
+ */
+class ArnoldiSolver : public Solver
+{
+    protected:
+        int k; /// Number of wanted eigenvalues
+        int m; /// Size of the Krylov subspace
+        std::string which; /// Wanted part of the spectrum: "LM", "LR" or "SR"
+        Eigen::MatrixXcd V; /// Orthonormal Krylov basis, one extra column for the residual
+        Eigen::MatrixXcd H; /// Upper Hessenberg projection of the matrix, one extra row
+        /**
+         * @brief Extends the Arnoldi factorization from j0 to m vectors.
+         * @param j0 Current size of the factorization.
+         */
+        void extendFactorization(int j0);
+        /**
+         * @brief Orders Ritz values from most to least wanted.
+         * @param ritz_vals Ritz values to sort.
+         * @return Indices of the Ritz values in order of preference.
+         */
+        std::vector<int> sortRitzValues(Eigen::VectorXcd const& ritz_vals);
+    public:
+        /**
+        * @brief Constructs an ArnoldiSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        ArnoldiSolver(InputData input);
+        /// ArnoldiSolver destructor
+        ~ArnoldiSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Finds the wanted eigenvalues with the implicitly restarted Arnoldi method.
+        */
+        void solve() override;
+};
+
+/**
+ * @class SubspaceSolver
+ * @brief Derived Solver class that finds k eigenvalues at once with block subspace iteration.
+ *
+ * Iterates a block of k vectors with the shifted (or shift-inverted) matrix, so that
+ * every step is a matrix-matrix product instead of k matrix-vector products. The block
+ * is re-orthonormalized with a QR decomposition and a Rayleigh-Ritz projection extracts
+ * k eigenvalue approximations. Converged leading vectors are locked and no longer iterated.
+ */
+class SubspaceSolver : public Solver
+{
+    protected:
+        int k; /// Number of wanted eigenvalues, i.e. block size
+        Eigen::dcomplex shift; /// Shift @f$ \mu @f$
+        bool inverse; /// Iterate with @f$ (A - \mu I)^{-1} @f$ instead of @f$ A - \mu I @f$
+        /// Factorization of the shifted matrix, only used by the inverse variant
+        std::unique_ptr<Factorization> decomp;
+        double factorization_time; /// Time spent factorizing, in microseconds
+    public:
+        /**
+        * @brief Constructs a SubspaceSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        SubspaceSolver(InputData input);
+        /// SubspaceSolver destructor
+        ~SubspaceSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Finds k eigenvalues with block subspace iteration and Rayleigh-Ritz projection.
+        */
+        void solve() override;
+};
+
+/**
+ * @class MultiShiftSolver
+ * @brief Derived Solver class that runs inverse iteration for many shifts in one run.
+ *
+ * Every shift is factorized and iterated independently on a pool of worker threads,
+ * which all read the same input matrix. Eigenvalues that several shifts converge to
+ * are merged, so the output holds every distinct eigenvalue found.
+ */
+class MultiShiftSolver : public Solver
+{
+    protected:
+        std::vector<Eigen::dcomplex> shifts; /// Shifts @f$ \mu_j @f$, one inverse iteration each
+        int num_threads; /// Number of worker threads
+        std::string factorization_type; /// Factorization strategy for the shifted matrices
+        double merge_tol; /// Relative distance below which two eigenvalues are merged
+        /**
+         * @brief Result of the inverse iteration for a single shift.
+         */
+        struct ShiftResult {
+            Eigen::dcomplex eigenval; /// Estimated eigenvalue
+            double residual; /// Residual norm of the eigenpair
+            int iterations; /// Number of iterations performed
+        };
+        /**
+         * @brief Runs inverse iteration with a single shift.
+         * @param shift The shift @f$ \mu @f$.
+         * @param shift_seed Seed of the random starting vector.
+         * @return ShiftResult with the eigenvalue closest to the shift.
+         */
+        ShiftResult inverseIteration(Eigen::dcomplex shift, unsigned int shift_seed) const;
+    public:
+        /**
+        * @brief Constructs a MultiShiftSolver object.
+        * @param input The input data of the problem contained in InputData struct.
+        */
+        MultiShiftSolver(InputData input);
+        /// MultiShiftSolver destructor
+        ~MultiShiftSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Runs inverse iteration for every shift in parallel and merges the eigenvalues found.
+        */
+        void solve() override;
+};
+
+/**
+ * @class MultiResolutionSolver
+ * @brief Derived Solver class that solves downsampled copies of the input from coarse to fine.
+ *
+ * The coarsest level is solved from a random start. The eigenvectors found at every
+ * level are interpolated to the next finer size and used as the warm start of the
+ * power or subspace iteration there, so that the expensive finest level only needs
+ * a few iterations.
+ */
+class MultiResolutionSolver : public Solver
+{
+    protected:
+        std::vector<Eigen::MatrixXcd> levels; /// Coarser levels, coarsest first
+        InputData finest; /// Input of the finest level
+        /**
+         * @brief Interpolates vectors linearly to a finer size.
+         * @param V Vectors to interpolate, one per column.
+         * @param size Number of rows of the result.
+         * @return 'Eigen::MatrixXcd' with the interpolated vectors, normalized.
+         */
+        static Eigen::MatrixXcd upsample(Eigen::MatrixXcd const& V, int size);
+    public:
+        /**
+        * @brief Constructs a MultiResolutionSolver object.
+        * @param input The input data of the problem, with its coarse levels.
+        */
+        MultiResolutionSolver(InputData input);
+        /// MultiResolutionSolver destructor
+        ~MultiResolutionSolver() {};
+        /**
+        * @brief Overriden solve method from Solver class.
+        * Solves every level with the method of the input, warm started from the previous one.
+        * The matrices are moved into the solvers of the levels and taken back afterwards.
+        */
+        void solve() override;
+};
+
 #endif //SOLVER_H
 
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <algorithm>
+#include "ThreadPool.h"
+
+/** @file ThreadPool.cc
+ * @brief Implementation file for the work-stealing thread pool.
+ */
+
+/// Index of the pool worker running on this thread, -1 outside of the pool
+static thread_local int worker_id = -1;
+/// Pool owning the worker running on this thread
+static thread_local ThreadPool const* worker_pool = nullptr;
+
+/**
+ * @brief ThreadPool constructor, starts the worker threads.
+ * @param num_threads Number of workers, 0 uses all hardware threads.
+ */
+ThreadPool::ThreadPool(int num_threads) : next_queue(0), queued(0), pending(0), stop(false)
+{
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i=0; i<num_threads; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (int i=0; i<num_threads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief ThreadPool destructor.
+ *
+ * Finishes the submitted tasks before stopping and joining the workers.
+ */
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stop = true;
+    }
+    work_available.notify_all();
+    for (auto & worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Adds a task to the pool.
+ * @param task Function to run.
+ */
+void ThreadPool::submit(std::function<void()> task)
+{
+    int id = (worker_pool == this) ? worker_id : next_queue++ % queues.size();
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(queues[id]->mutex);
+        queues[id]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        queued++;
+    }
+    work_available.notify_one();
+}
+
+/**
+ * @brief Takes a task from the worker's own queue or steals one from another queue.
+ *
+ * The own queue is used as a stack (most recent task first) and the other queues
+ * are robbed from the front, where the oldest and usually largest tasks are.
+ * @param id Index of the worker.
+ * @param task Output task.
+ * @return True if a task was found.
+ */
+bool ThreadPool::popTask(int id, std::function<void()> & task)
+{
+    int num_queues = queues.size();
+    for (int k=0; k<num_queues; k++) {
+        TaskQueue & queue = *queues[(id + k) % num_queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Main loop of a worker thread.
+ *
+ * Runs tasks until the pool is stopped, sleeping while there is no work. Exceptions
+ * escaping a task are reported and do not stop the worker.
+ * @param id Index of the worker.
+ */
+void ThreadPool::workerLoop(int id)
+{
+    worker_id = id;
+    worker_pool = this;
+    while (true) {
+        std::function<void()> task;
+        if (popTask(id, task)) {
+            try {
+                task();
+            }
+            catch (const std::exception &e) {
+                std::cerr << "WARNING: Task failed: " << e.what() << std::endl << std::flush;
+            }
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                all_done.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state_mutex);
+        work_available.wait(lock, [this]() { return stop || queued > 0; });
+        if (stop && queued == 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Blocks until every submitted task has finished.
+ */
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(state_mutex);
+    all_done.wait(lock, [this]() { return pending == 0; });
+}
+
+/**
+ * @brief Number of worker threads.
+ * @return Number of workers in the pool.
+ */
+int ThreadPool::size() const
+{
+    return workers.size();
+}
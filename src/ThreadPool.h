@@ -0,0 +1,81 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @file ThreadPool.h
+ * @brief Header file for the work-stealing thread pool.
+ */
+
+/**
+ * @class ThreadPool
+ * @brief Fixed size thread pool with one task queue per worker and work stealing.
+ *
+ * Every worker pops tasks from the back of its own queue and, when it is empty,
+ * steals from the front of the other queues, so that short and long tasks
+ * balance across the workers.
+ */
+class ThreadPool
+{
+    private:
+        /// Task queue of a single worker
+        struct TaskQueue {
+            std::deque<std::function<void()>> tasks;
+            std::mutex mutex;
+        };
+        std::vector<std::unique_ptr<TaskQueue>> queues; /// One queue per worker
+        std::vector<std::thread> workers; /// Worker threads
+        std::atomic<unsigned int> next_queue; /// Round-robin queue for external submissions
+        std::atomic<int> queued; /// Tasks waiting in the queues
+        std::atomic<int> pending; /// Tasks submitted and not finished yet
+        std::mutex state_mutex; /// Protects the waits on the condition variables
+        std::condition_variable work_available; /// Wakes idle workers
+        std::condition_variable all_done; /// Wakes threads waiting for completion
+        bool stop; /// Set on destruction to end the workers
+        /**
+         * @brief Takes a task from the worker's own queue or steals one from another queue.
+         * @param id Index of the worker.
+         * @param task Output task.
+         * @return True if a task was found.
+         */
+        bool popTask(int id, std::function<void()> & task);
+        /**
+         * @brief Main loop of a worker thread.
+         * @param id Index of the worker.
+         */
+        void workerLoop(int id);
+    public:
+        /**
+         * @brief Starts the worker threads.
+         * @param num_threads Number of workers, 0 uses all hardware threads.
+         */
+        ThreadPool(int num_threads);
+        /// Waits for the remaining tasks and joins the workers
+        ~ThreadPool();
+        /**
+         * @brief Adds a task to the pool.
+         *
+         * Tasks submitted from a worker go to its own queue, other tasks are
+         * distributed round-robin.
+         * @param task Function to run.
+         */
+        void submit(std::function<void()> task);
+        /**
+         * @brief Blocks until every submitted task has finished.
+         */
+        void wait();
+        /**
+         * @brief Number of worker threads.
+         * @return Number of workers in the pool.
+         */
+        int size() const;
+};
+
+#endif //THREADPOOL_H
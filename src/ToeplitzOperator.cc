@@ -0,0 +1,136 @@
+#include <cmath>
+#include "ToeplitzOperator.h"
+
+/** @file ToeplitzOperator.cc
+ * @brief Implementation file for the FFT-based operator of Toeplitz and circulant matrices.
+ */
+
+/**
+ * @brief Smallest power of two not below a number.
+ * @param m The number.
+ * @return Power of two @f$ \geq m @f$.
+ */
+static int nextPowerOfTwo(int m)
+{
+    int p = 1;
+    while (p < m) {
+        p *= 2;
+    }
+    return p;
+}
+
+/**
+ * @brief ToeplitzOperator constructor
+ *
+ * The matrix is embedded in a circulant matrix of power of two size m >= 2n - 1, whose
+ * first column is the first column of the matrix, zeros, then the first row reversed.
+ * Its FFT is computed once.
+ * @param first_col First column of the matrix.
+ * @param first_row First row of the matrix, its first entry is ignored.
+ */
+ToeplitzOperator::ToeplitzOperator(Eigen::VectorXcd const& first_col, Eigen::VectorXcd const& first_row)
+    : n(first_col.size()), first_col(first_col), first_row(first_row)
+{
+    this->first_row(0) = first_col(0);
+    int m = nextPowerOfTwo(2*n - 1);
+    Eigen::VectorXcd embedding = Eigen::VectorXcd::Zero(m);
+    embedding.head(n) = first_col;
+    for (int k=1; k<n; k++) {
+        embedding(m - k) = first_row(k);
+    }
+    fft.fwd(embedding_fft, embedding);
+}
+
+/// Number of rows (and columns) of the operator
+int ToeplitzOperator::size() const
+{
+    return n;
+}
+
+/**
+ * @brief Applies the operator to a vector with FFTs of the circulant embedding.
+ * @param x Input vector.
+ * @param y Output vector @f$ y = A x @f$.
+ */
+void ToeplitzOperator::apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    int m = embedding_fft.size();
+    Eigen::VectorXcd padded = Eigen::VectorXcd::Zero(m);
+    padded.head(n) = x;
+    Eigen::VectorXcd padded_fft, product;
+    fft.fwd(padded_fft, padded);
+    padded_fft.array() *= embedding_fft.array();
+    fft.inv(product, padded_fft);
+    y = product.head(n);
+}
+
+/**
+ * @brief Builds the dense matrix from the first column and row.
+ * @return 'Eigen::MatrixXcd' containing the operator.
+ */
+Eigen::MatrixXcd ToeplitzOperator::toDense() const
+{
+    Eigen::MatrixXcd M(n, n);
+    for (int j=0; j<n; j++) {
+        for (int i=0; i<n; i++) {
+            M(i, j) = (i >= j) ? first_col(i - j) : first_row(j - i);
+        }
+    }
+    return M;
+}
+
+/// True if every row is the previous one rotated by one entry
+bool ToeplitzOperator::isCirculant() const
+{
+    for (int k=1; k<n; k++) {
+        if (first_row(k) != first_col(n - k)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// True if the first row is the conjugate of the first column
+bool ToeplitzOperator::isHermitian() const
+{
+    return first_row == first_col.conjugate();
+}
+
+/**
+ * @brief Eigenvalues of a circulant matrix, the DFT of its first column.
+ *
+ * Power of two sizes use the FFT directly. Other sizes use Bluestein's algorithm, which
+ * writes the DFT as a convolution computed with power of two FFTs, so that the cost
+ * stays O(n log n) whatever the prime factors of n.
+ * @return 'Eigen::VectorXcd' of the n eigenvalues.
+ */
+Eigen::VectorXcd ToeplitzOperator::circulantEigenvalues() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Eigen::VectorXcd eigenvalues;
+    if (nextPowerOfTwo(n) == n) {
+        fft.fwd(eigenvalues, first_col);
+        return eigenvalues;
+    }
+
+    // Chirp w_j = exp(-i pi j^2 / n), with j^2 reduced modulo 2n to keep the angle accurate
+    Eigen::VectorXcd chirp(n);
+    for (long j=0; j<n; j++) {
+        chirp(j) = std::polar(1.0, -M_PI * static_cast<double>((j * j) % (2L * n)) / n);
+    }
+    int m = nextPowerOfTwo(2*n - 1);
+    Eigen::VectorXcd a = Eigen::VectorXcd::Zero(m), b = Eigen::VectorXcd::Zero(m);
+    a.head(n) = first_col.cwiseProduct(chirp);
+    b.head(n) = chirp.conjugate();
+    for (int j=1; j<n; j++) {
+        b(m - j) = std::conj(chirp(j));
+    }
+    Eigen::VectorXcd a_fft, b_fft, convolution;
+    fft.fwd(a_fft, a);
+    fft.fwd(b_fft, b);
+    a_fft.array() *= b_fft.array();
+    fft.inv(convolution, a_fft);
+    eigenvalues = chirp.cwiseProduct(convolution.head(n));
+    return eigenvalues;
+}
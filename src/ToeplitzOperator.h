@@ -0,0 +1,60 @@
+#ifndef TOEPLITZOPERATOR_H
+#define TOEPLITZOPERATOR_H
+
+#include <mutex>
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+#include "LinearOperator.h"
+
+/** @file ToeplitzOperator.h
+ * @brief Header file for the FFT-based operator of Toeplitz and circulant matrices.
+ */
+
+/**
+ * @class ToeplitzOperator
+ * @brief Operator of a Toeplitz matrix @f$ a_{ij} = t_{i-j} @f$, stored by its first column and row.
+ *
+ * Products embed the matrix in a circulant matrix of power of two size and are computed
+ * with FFTs in O(n log n), with O(n) memory. A circulant matrix is the special case
+ * @f$ t_{k} = t_{k-n} @f$; its eigenvalues are the discrete Fourier transform of the
+ * first column.
+ */
+class ToeplitzOperator : public LinearOperator
+{
+    protected:
+        int n; /// Number of rows and columns
+        Eigen::VectorXcd first_col; /// First column @f$ t_0, t_1, \ldots, t_{n-1} @f$
+        Eigen::VectorXcd first_row; /// First row @f$ t_0, t_{-1}, \ldots, t_{1-n} @f$
+        Eigen::VectorXcd embedding_fft; /// FFT of the first column of the circulant embedding
+        mutable Eigen::FFT<double> fft; /// FFT plans, reused between products
+        mutable std::mutex mutex; /// Serializes the products, as the plans are shared
+    public:
+        /**
+         * @brief ToeplitzOperator constructor
+         * @param first_col First column of the matrix.
+         * @param first_row First row of the matrix, its first entry is ignored.
+         */
+        ToeplitzOperator(Eigen::VectorXcd const& first_col, Eigen::VectorXcd const& first_row);
+        /// ToeplitzOperator destructor
+        ~ToeplitzOperator() {};
+        int size() const override;
+        void apply(Eigen::Ref<const Eigen::VectorXcd> x, Eigen::Ref<Eigen::VectorXcd> y) const override;
+        Eigen::MatrixXcd toDense() const override;
+        /**
+         * @brief Checks whether the matrix is circulant.
+         * @return True if every row is the previous one rotated by one entry.
+         */
+        bool isCirculant() const;
+        /**
+         * @brief Checks whether the matrix is Hermitian.
+         * @return True if the first row is the conjugate of the first column.
+         */
+        bool isHermitian() const;
+        /**
+         * @brief Eigenvalues of a circulant matrix, the DFT of its first column.
+         * @return 'Eigen::VectorXcd' whose k-th entry belongs to the Fourier vector @f$ e^{2 \pi i jk/n} @f$.
+         */
+        Eigen::VectorXcd circulantEigenvalues() const;
+};
+
+#endif //TOEPLITZOPERATOR_H
@@ -1,15 +1,122 @@
 #include <iostream>
 #include <filesystem>
 #include <exception>
+#include <memory>
+#include <charconv>
 #include "utils.h"
 #include "Reader.h"
 #include "Solver.h"
 #include "Exceptions.h"
 #include "OutputGenerator.h"
+#include "BatchRunner.h"
+#include "ImagePipeline.h"
+#include "BinaryMatrix.h"
 
+/**
+ * @brief Batch mode: main --batch <directory|manifest> [--threads N] [--output path]
+ */
+int runBatch(int argc, char **argv)
+{
+    std::string output_path = "./batch_output.csv";
+    int num_threads = 0;
+    for (int i=3; i<argc; i+=2) {
+        std::string option = argv[i];
+        if (i + 1 == argc) {
+            std::cout << "Usage error: missing value for " << option << std::endl;
+            std::cout << "Usage: main --batch <directory|manifest> [--threads N] [--output path]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (option == "--threads") {
+            std::string value = argv[i+1];
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), num_threads);
+            if (ec != std::errc() || end != value.data() + value.size() || num_threads < 0) {
+                std::cout << "Usage error: --threads expects a non-negative integer, got " << value << std::endl;
+                std::cout << "Usage: main --batch <directory|manifest> [--threads N] [--output path]" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (option == "--output") {
+            output_path = argv[i+1];
+        }
+        else {
+            std::cerr << "WARNING: Unknown batch option " << option << std::endl;
+        }
+    }
+    try {
+        BatchRunner batch(argv[2], num_threads);
+        batch.run();
+        batch.saveOutput(output_path);
+        return batch.numFailed() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const ConfigError &e) {
+        std::cout << "Configuration File error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/**
+ * @brief Pipeline mode: main --pipeline <config> [--output path]
+ *
+ * The PICTURE path of the configuration is a directory or pattern of images.
+ */
+int runPipeline(int argc, char **argv)
+{
+    std::string output_path = "./pipeline_output.csv";
+    for (int i=3; i+1<argc; i+=2) {
+        std::string option = argv[i];
+        if (option == "--output") {
+            output_path = argv[i+1];
+        }
+        else {
+            std::cerr << "WARNING: Unknown pipeline option " << option << std::endl;
+        }
+    }
+    try {
+        ImagePipeline pipeline(argv[2]);
+        pipeline.run();
+        pipeline.saveOutput(output_path);
+        return pipeline.numFailed() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const ConfigError &e) {
+        std::cout << "Configuration File error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
+
+/**
+ * @brief Conversion mode: main --convert <input.csv> <output.bin>
+ *
+ * Matrices without imaginary part are stored as real numbers.
+ */
+int runConvert(char **argv)
+{
+    try {
+        FileReader reader("QR", 1, 1e-9, nlohmann::json(), argv[2]);
+        reader.genMatrix();
+        Eigen::MatrixXcd const& A = reader.getInputData().input_matrix;
+        bool real = A.imag().isZero(0.0);
+        writeBinaryMatrix(A, argv[3], real);
+        std::cout << "Binary " << (real ? "real" : "complex") << " matrix saved to " << argv[3] << std::endl;
+        return EXIT_SUCCESS;
+    }
+    catch (const ReaderError &e) {
+        std::cout << "Reader error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
 
 int main(int argc, char **argv)
 {
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        return runBatch(argc, argv);
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--pipeline") {
+        return runPipeline(argc, argv);
+    }
+    if (argc == 4 && std::string(argv[1]) == "--convert") {
+        return runConvert(argv);
+    }
+
     Reader * reader;
     try {
         if (argc==1) {
@@ -35,13 +142,35 @@ int main(int argc, char **argv)
     }
 
     std::cout << "Successfully created reader." << std::endl;
-    Solver * solver = createSolver(reader);
-    std::cout << "Successfully created solver." << std::endl;
-    solver->solve();
+    std::cout << "Peak memory after reading: " << peakMemoryMB() << " MB" << std::endl;
+    // Owned here, so that it is freed when solve() throws
+    std::unique_ptr<Solver> solver;
+    try {
+        solver.reset(createSolver(reader));
+        std::cout << "Successfully created solver." << std::endl;
+        std::cout << "Peak memory after creating the solver: " << peakMemoryMB() << " MB" << std::endl;
+        solver->solve();
+    }
+    catch (const ConfigError &e) {
+        std::cout << "Configuration File error: " << e.what() << std::endl;
+        delete reader;
+        return EXIT_FAILURE;
+    }
+    catch (const ReaderError &e) {
+        std::cout << "Reader error: " << e.what() << std::endl;
+        delete reader;
+        return EXIT_FAILURE;
+    }
+    catch (const std::exception &e){
+        std::cout << e.what() << std::endl;
+        delete reader;
+        return EXIT_FAILURE;
+    }
 
-    OutputGenerator x(solver->getOutput());
+    OutputData output = solver->getOutput();
+    output.metrics.emplace_back("Peak Memory", std::to_string(peakMemoryMB()) + " MB");
+    OutputGenerator x(output);
     x.saveOutput();
 
     delete reader;
-    delete solver;
 }
\ No newline at end of file
@@ -1,13 +1,21 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <filesystem>
 #include <string>
+#include <limits>
+#include <charconv>
+#include <chrono>
 #include <nlohmann/json.hpp>
 #include "Exceptions.h"
 #include "utils.h"
 #include "Reader.h"
 #include "Solver.h"
+#include "ImagePipeline.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 /** @file utils.cc
  * @brief Implementation file for utility functions.
@@ -15,12 +23,12 @@
 
 using json = nlohmann::json;
 
-/** 
- * @brief Create Reader object based off of a configuration file.
- * @param file_path 'std::filesystem::path' object for the path to a run's configuration file. 
- * @return Reader object which points to a dynamically allocated daughter of Reader class
+/**
+ * @brief Opens and parses a configuration file.
+ * @param file_path 'std::filesystem::path' object for the path to a run's configuration file.
+ * @return JSON object with the configuration.
  */
-Reader* createReader(std::filesystem::path file_path)
+json readConfig(std::filesystem::path file_path)
 {
     // Open input stream object and check existence
     std::cout << "Opening file ... " << std::filesystem::absolute(file_path) << std::endl << std::flush;
@@ -32,7 +40,16 @@ Reader* createReader(std::filesystem::path file_path)
     // Create json object
     json data = json::parse(config_file);
     config_file.close();
+    return data;
+}
 
+/**
+ * @brief Extracts the solver settings shared by all the input types from a configuration.
+ * @param data JSON object with the configuration.
+ * @return InputData with the method, iterations, tolerance, method parameters and seed set, and no matrix.
+ */
+InputData readRunConfig(json const& data)
+{
     // Extract run configuration
     std::string data_type;
     data_type = getJsonValueNecessary<std::string, ConfigError>(data, "INPUT",
@@ -50,6 +67,9 @@ Reader* createReader(std::filesystem::path file_path)
     tol = getJsonValueOptional<double>(data, "TOLERANCE",
         "WARNING: Missing tolerance. Defaulting to 1e-9.", 1e-9);
 
+    // Seed of the solver's random number generator, silently 0 so runs are reproducible
+    unsigned int seed = data.value("SEED", 0u);
+
     // Method-specific parameters. If missing, use default ones.
     json opt_params;
     try {
@@ -61,10 +81,10 @@ Reader* createReader(std::filesystem::path file_path)
     }
 
     // Exception when valid option not given
-    std::vector<std::string> supported_data_types = {"FILE", "FUNCTION", "PICTURE"};
-    std::vector<std::string> supported_methods = {"QR", "POWER", "INVERSE"};
+    std::vector<std::string> supported_data_types = {"FILE", "FUNCTION", "PICTURE", "SPARSE", "BINARY", "MTX"};
+    std::vector<std::string> supported_methods = {"QR", "SHIFTED_QR", "FRANCIS", "HERMITIAN", "ARNOLDI", "SUBSPACE", "POWER", "INVERSE"};
     if (std::find(supported_data_types.begin(), supported_data_types.end(), data_type) == supported_data_types.end()) {
-        throw ConfigError("Unsupported data type. Input data needs to be either a file, a picture. or a function");
+        throw ConfigError("Unsupported data type. Input data needs to be either a file, a sparse file, a binary file, a Matrix Market file, a picture. or a function");
     }
     if (std::find(supported_methods.begin(), supported_methods.end(), method) == supported_methods.end()) {
         std::cerr <<"WARNING: Unsupported solver method. Defaulting to QR method." << std::endl << std::flush;
@@ -81,16 +101,46 @@ Reader* createReader(std::filesystem::path file_path)
         tol = 1e-16;
     }
 
+    InputData run;
+    run.method = method;
+    run.num_iters = max_iters;
+    run.tol = tol;
+    run.method_config = opt_params;
+    run.seed = seed;
+    run.size = 0;
+    // Balancing of the input matrix, silently off if missing
+    run.balance = data.value("BALANCE", false);
+    return run;
+}
+
+/** 
+ * @brief Create Reader object based off of a configuration file.
+ * @param file_path 'std::filesystem::path' object for the path to a run's configuration file. 
+ * @return Reader object which points to a dynamically allocated daughter of Reader class
+ */
+Reader* createReader(std::filesystem::path file_path)
+{
+    json data = readConfig(file_path);
+    InputData run = readRunConfig(data);
+    std::string data_type = data["INPUT"];
+    std::string method = run.method;
+    int max_iters = run.num_iters;
+    double tol = run.tol;
+    json opt_params = run.method_config;
+    unsigned int seed = run.seed;
+
     // Creating reader depending on the type of input data
+    Reader * reader;
     if (data_type == "FILE") {
         std::string file_path;
         file_path = getJsonValueNecessary<std::string, ConfigError>(data["FILE"], "PATH",
             "ERROR: Missing input data file path.");
 
-        Reader *file_reader = new FileReader(method, max_iters, tol,
-            opt_params, file_path);
-        tryGenMatrix(file_reader);
-        return file_reader;
+        // Number of parsing threads, silently 0 (all hardware threads) if missing
+        int threads = data["FILE"].value("THREADS", 0);
+
+        reader = new FileReader(method, max_iters, tol,
+            opt_params, file_path, threads);
     }
     else if (data_type == "FUNCTION") {
         std::string func;
@@ -99,43 +149,188 @@ Reader* createReader(std::filesystem::path file_path)
             "ERROR: Missing matrix generating function.");
         size = getJsonValueNecessary<int, ConfigError>(data["FUNCTION"], "SIZE",
             "ERROR: Missing matrix size.");
-        FunctionReader * function_reader = new FunctionReader(method, max_iters, tol,
-            opt_params, func, size);
-        tryGenMatrix(function_reader);
-        return function_reader;
+
+        // Symmetry hint, number of threads and matrix-free mode, silently off, 0 (all hardware threads) and off if missing
+        bool symmetric = data["FUNCTION"].value("SYMMETRIC", false);
+        int threads = data["FUNCTION"].value("THREADS", 0);
+        bool matrix_free = data["FUNCTION"].value("MATRIX_FREE", false);
+
+        // Toeplitz or circulant structure, silently "NONE" if missing
+        std::string structure = data["FUNCTION"].value("STRUCTURE", "NONE");
+        std::vector<std::string> supported_structures = {"NONE", "AUTO", "TOEPLITZ", "CIRCULANT"};
+        if (std::find(supported_structures.begin(), supported_structures.end(), structure) == supported_structures.end()) {
+            std::cerr << "WARNING: Unsupported function structure. Defaulting to NONE." << std::endl << std::flush;
+            structure = "NONE";
+        }
+
+        reader = new FunctionReader(method, max_iters, tol,
+            opt_params, func, size, symmetric, threads, matrix_free, structure);
     }
     else if (data_type == "PICTURE") {
         std::string picture_path;
         picture_path = getJsonValueNecessary<std::string, ConfigError>(data["PICTURE"], "PATH",
             "ERROR: Missing picture path.");
+        if (isPictureSet(picture_path)) {
+            throw ConfigError("ERROR: Picture path is a directory or pattern. Use --pipeline to solve every image.");
+        }
 
-        PictureReader * picture_reader = new PictureReader(method, max_iters, tol,
-            opt_params, picture_path);
-        tryGenMatrix(picture_reader);
-        return picture_reader;
+        // Pyramid levels and size of the finest level, silently 1 and the image size if missing
+        int levels = data["PICTURE"].value("LEVELS", 1);
+        int target_size = data["PICTURE"].value("TARGET_SIZE", 0);
+        if (levels < 1) {
+            std::cerr << "WARNING: Invalid number of levels. Defaulting to 1." << std::endl << std::flush;
+            levels = 1;
+        }
+
+        reader = new PictureReader(method, max_iters, tol,
+            opt_params, picture_path, levels, target_size);
     }
+    else if (data_type == "SPARSE") {
+        std::string file_path;
+        file_path = getJsonValueNecessary<std::string, ConfigError>(data["SPARSE"], "PATH",
+            "ERROR: Missing sparse matrix file path.");
+
+        reader = new SparseFileReader(method, max_iters, tol,
+            opt_params, file_path);
+    }
+    else if (data_type == "BINARY") {
+        std::string file_path;
+        file_path = getJsonValueNecessary<std::string, ConfigError>(data["BINARY"], "PATH",
+            "ERROR: Missing binary matrix file path.");
+
+        // Out-of-core streaming, silently off if missing; the budget is given in megabytes
+        std::size_t block_budget = 0;
+        if (data["BINARY"].value("OUT_OF_CORE", false)) {
+            double block_mb = data["BINARY"].value("BLOCK_MB", 256.0);
+            if (block_mb <= 0) {
+                std::cerr << "WARNING: Invalid BLOCK_MB. Defaulting to 256." << std::endl << std::flush;
+                block_mb = 256.0;
+            }
+            block_budget = static_cast<std::size_t>(block_mb * 1e6);
+        }
+
+        reader = new BinaryFileReader(method, max_iters, tol,
+            opt_params, file_path, block_budget);
+    }
+    else {
+        std::string file_path;
+        file_path = getJsonValueNecessary<std::string, ConfigError>(data["MTX"], "PATH",
+            "ERROR: Missing Matrix Market file path.");
+
+        reader = new MatrixMarketReader(method, max_iters, tol,
+            opt_params, file_path);
+    }
+    reader->setSeed(seed);
+    reader->setBalance(run.balance);
+    tryGenMatrix(reader);
+    return reader;
 }
 
 /**
  * @brief Create a Solver object based off of Reader object provided
+ * 
+ * The input data is moved out of the reader, so the matrix is handed to the solver
+ * without a copy and the reader is left without matrix.
  * @param reader Reader object that contains InputData needed for solver
  * @return Solver object which points to a dynamically allocated daughter of Solver class
  */
 Solver* createSolver(Reader * reader)
 {
-    InputData input = reader->getInputData();
+    return createSolver(reader->takeInputData());
+}
+
+/**
+ * @brief Create a Solver object for the input data provided
+ * @param input InputData with the matrix or operator and the solver settings
+ * @return Solver object which points to a dynamically allocated daughter of Solver class
+ */
+Solver* createSolver(InputData input)
+{
     Solver * solver;
+
+    // All the eigenvalues of a circulant matrix are given by an FFT of its first column
+    auto toeplitz = std::dynamic_pointer_cast<ToeplitzOperator>(input.op);
+    bool all_eigenvalues = (input.method == "QR" || input.method == "SHIFTED_QR" || input.method == "FRANCIS" || input.method == "HERMITIAN");
+    if (toeplitz && toeplitz->isCirculant() && all_eigenvalues) {
+        std::cout << "Input matrix is circulant. Computing the eigenvalues by FFT." << std::endl;
+        return new CirculantSolver(std::move(input));
+    }
+
+    // Only the power, Arnoldi and subspace methods work through matrix-vector products
+    bool matrix_free = (input.method == "POWER" || input.method == "ARNOLDI" || input.method == "SUBSPACE");
+    if (!matrix_free && input.input_matrix.size() == 0 && input.op) {
+        std::cerr << "WARNING: Method " << input.method << " needs a dense matrix. Converting input to dense." << std::endl << std::flush;
+        input.input_matrix = input.op->toDense();
+        input.op.reset();
+    }
+
+    if (input.balance) {
+        if (!input.coarse_levels.empty()) {
+            std::cerr << "WARNING: Balancing is not supported by multi-resolution solves. Skipping balancing." << std::endl << std::flush;
+        }
+        else if (input.input_matrix.size() == 0) {
+            std::cerr << "WARNING: Balancing needs a dense matrix. Skipping balancing." << std::endl << std::flush;
+        }
+        else {
+            balanceInput(input);
+        }
+    }
+
+    // Downsampled levels are solved from coarse to fine by the power and subspace methods
+    if (!input.coarse_levels.empty()) {
+        if (input.method == "POWER" || input.method == "SUBSPACE") {
+            return new MultiResolutionSolver(std::move(input));
+        }
+        std::cerr << "WARNING: Multi-resolution solves need the POWER or SUBSPACE method. Solving the finest level only." << std::endl << std::flush;
+        input.coarse_levels.clear();
+    }
+
     if (input.method == "QR")
     {
-        solver = new QRSolver(reader->getInputData());
+        solver = new QRSolver(std::move(input));
+    }
+    else if (input.method == "SHIFTED_QR" || input.method == "FRANCIS" || input.method == "HERMITIAN")
+    {
+        // Hermitian matrices (flagged by the reader or detected) are solved by
+        // tridiagonal divide-and-conquer, other real matrices in real arithmetic
+        if (input.hermitian || isHermitian(input.input_matrix)) {
+            std::cout << "Input matrix is Hermitian. Using divide-and-conquer method." << std::endl;
+            solver = new HermitianSolver(std::move(input));
+        }
+        else if (input.input_matrix.imag().isZero(0.0)) {
+            if (input.method == "HERMITIAN") {
+                std::cerr << "WARNING: Input matrix is not Hermitian. Using Francis double-shift QR method instead." << std::endl << std::flush;
+            }
+            solver = new FrancisQRSolver(std::move(input));
+        }
+        else {
+            if (input.method != "SHIFTED_QR") {
+                std::cerr << "WARNING: Input matrix is complex and not Hermitian. Using shifted QR method instead." << std::endl << std::flush;
+            }
+            solver = new ShiftedQRSolver(std::move(input));
+        }
+    }
+    else if (input.method == "ARNOLDI")
+    {
+        solver = new ArnoldiSolver(std::move(input));
+    }
+    else if (input.method == "SUBSPACE")
+    {
+        solver = new SubspaceSolver(std::move(input));
     }
     else if (input.method == "POWER")
     {
-        solver = new PowerSolver(reader->getInputData());
+        solver = new PowerSolver(std::move(input));
     }
     else if (input.method == "INVERSE")
     {
-        solver = new InverseSolver(reader->getInputData());
+        // A list or grid of shifts runs all inverse iterations in one solver
+        if (input.method_config.contains("SHIFTS") || input.method_config.contains("SHIFT_GRID")) {
+            solver = new MultiShiftSolver(std::move(input));
+        }
+        else {
+            solver = new InverseSolver(std::move(input));
+        }
     }
     return solver;
 }
@@ -149,62 +344,276 @@ void setDefaultVals(std::string method, json &opt_params) {
     if (method == "QR") {
         opt_params = json(); // QR takes no params
     }
+    else if (method == "SHIFTED_QR" || method == "FRANCIS") {
+        opt_params = json(); // Shifted QR takes no params
+    }
+    else if (method == "HERMITIAN") {
+        opt_params["THREADS"] = 0; // 0 uses all hardware threads
+    }
+    else if (method == "ARNOLDI") {
+        opt_params["K"] = 10;
+        opt_params["KRYLOV_SIZE"] = 0; // 0 uses max(2K+1, 20)
+        opt_params["WHICH"] = "LM";
+    }
+    else if (method == "SUBSPACE") {
+        opt_params["K"] = 4;
+        opt_params["SHIFT"] = "0";
+        opt_params["INVERSE"] = false;
+        opt_params["FACTORIZATION"] = "AUTO";
+    }
     else if (method == "POWER") {
         opt_params["SHIFT"] = 0;
     }
     else if (method == "INVERSE") {
         opt_params["SHIFT"] = 0;
+        opt_params["FACTORIZATION"] = "AUTO";
     }
 }
 
+/**
+ * @brief Lex a complex literal in the format "a + bi" in place
+ * 
+ * Accepts "a", "bi", "a + bi", "a - bi" and the shorthands "i", "a + i", "a - i",
+ * with optional blanks between the parts. Numbers are parsed with std::from_chars,
+ * so nothing is copied or allocated.
+ * @param first Pointer to the first character of the literal
+ * @param last Pointer past the last character that may be read
+ * @param value 'std::complex<double>&' receiving the complex number
+ * @return Pointer past the literal and the blanks following it, nullptr if the literal is invalid
+ */
+const char * lexComplex(const char * first, const char * last, std::complex<double> & value)
+{
+    const char * p = first;
+    auto skipBlanks = [&p, last]() {
+        while (p < last && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            p++;
+        }
+    };
+    auto lexNumber = [&p, last](double & x) {
+        if (p == last || *p == '+' || *p == '-') {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(p, last, x);
+        p = ptr;
+        return ec == std::errc();
+    };
+
+    skipBlanks();
+    double sign = 1.0, x;
+    if (p < last && (*p == '+' || *p == '-')) {
+        sign = (*p == '-') ? -1.0 : 1.0;
+        p++;
+        skipBlanks();
+    }
+    // Pure imaginary unit "i"
+    if (p < last && *p == 'i') {
+        p++;
+        skipBlanks();
+        value = std::complex<double>(0.0, sign);
+        return p;
+    }
+    if (!lexNumber(x)) {
+        return nullptr;
+    }
+    skipBlanks();
+    // Pure imaginary number "bi"
+    if (p < last && *p == 'i') {
+        p++;
+        skipBlanks();
+        value = std::complex<double>(0.0, sign*x);
+        return p;
+    }
+    double real = sign*x, imm = 0.0;
+    if (p < last && (*p == '+' || *p == '-')) {
+        double imm_sign = (*p == '-') ? -1.0 : 1.0;
+        p++;
+        skipBlanks();
+        if (p < last && *p == 'i') {
+            imm = imm_sign;
+        }
+        else {
+            if (!lexNumber(x)) {
+                return nullptr;
+            }
+            skipBlanks();
+            if (p == last || *p != 'i') {
+                return nullptr;
+            }
+            imm = imm_sign*x;
+        }
+        p++;
+        skipBlanks();
+    }
+    value = std::complex<double>(real, imm);
+    return p;
+}
+
 /**
  * @brief Create complex number representation of a string in the format "a + bi"
  * @param s 'std::string' in the format: real number + imag number * i
  * @return 'std::complex<double>' container with the complex number
+ * @throws std::invalid_argument if the string is not a complex number
  */
 std::complex<double> parseComplex(std::string s)
 {
-    s.erase(remove_if(s.begin(), s.end(), isspace), s.end());
-    int delim_pos = s.find('i');
-    double real, imm;
-
+    std::complex<double> value;
+    const char * last = s.data() + s.size();
+    const char * end = lexComplex(s.data(), last, value);
+    if (end == nullptr || end != last) {
+        throw std::invalid_argument("Invalid complex number: " + s);
+    }
+    return value;
+}
 
-    // No imaginary part, parse as a real number
-    if (delim_pos == std::string::npos) {
-        real = std::stod(s);
-        return std::complex<double>(real, 0);
+/**
+ * @brief Create complex number from a configuration value
+ * 
+ * Configurations may give a complex number as a string, or a real one as a plain number.
+ * @param value 'json' string in the format "a + bi", or real number
+ * @return 'std::complex<double>' container with the complex number
+ * @throws std::invalid_argument if the value is not a complex number
+ */
+std::complex<double> parseComplexValue(json const& value)
+{
+    if (value.is_number()) {
+        return std::complex<double>(value.get<double>(), 0.0);
     }
-    // Some edge cases (i "means" 1i)
-    if (s == "i") {
-        return std::complex<double>(0.0, 1.0);
-    } else if (s == "-i") {
-        return std::complex<double>(0.0, -1.0);
+    if (!value.is_string()) {
+        throw std::invalid_argument("Invalid complex number: " + value.dump());
     }
+    return parseComplex(value.get<std::string>());
+}
 
-    int plus_pos = s.find_last_of('+');
-    int min_pos = s.find_last_of('-');
+/// Radix of the balancing factors, scaling by its powers is exact in floating point
+static const double BALANCE_RADIX = 2;
+/// Maximum number of balancing sweeps
+static const int BALANCE_MAX_SWEEPS = 100;
+/// Smallest and largest scaled quantities, as LAPACK's sfmin1 and sfmax1, so that the scaling cannot underflow or overflow
+static const double BALANCE_SFMIN1 = std::numeric_limits<double>::min() / std::numeric_limits<double>::epsilon();
+static const double BALANCE_SFMAX1 = 1 / BALANCE_SFMIN1;
+/// Bounds of the norms while searching the factor, as LAPACK's sfmin2 and sfmax2
+static const double BALANCE_SFMIN2 = BALANCE_SFMIN1 * BALANCE_RADIX;
+static const double BALANCE_SFMAX2 = 1 / BALANCE_SFMIN2;
 
-    if (plus_pos != std::string::npos && delim_pos - plus_pos == 1) {
-        real = std::stod(s.substr(0,plus_pos));
-        imm = 1;
+/**
+ * @brief Balances a matrix in place by a diagonal similarity with powers of two.
+ * 
+ * Parlett and Reinsch's algorithm, as in LAPACK's gebal without permutations: every
+ * sweep scales row i by 1/f and column i by f, with f a power of two chosen so that the
+ * off-diagonal 1-norms of the row and the column are within a factor of 2, and only if
+ * it reduces their sum by at least 5%. Sweeps are repeated until no scaling is applied,
+ * at most BALANCE_MAX_SWEEPS times. As in gebal, the search for f stops before the norms
+ * or the largest entries of the row and column leave the safe range, and a factor that
+ * would take the diagonal of D below BALANCE_SFMIN1 or above BALANCE_SFMAX1 is skipped,
+ * so that no scaling overflows. The eigenvalues are unchanged and, since the factors are
+ * powers of two, the balanced matrix is exact barring underflow. Hermitian matrices are
+ * already balanced.
+ * @param A 'Eigen::MatrixXcd&' The matrix, replaced by @f$ D^{-1} A D @f$
+ * @param sweeps 'int&' Receives the number of sweeps over the rows and columns
+ * @return 'Eigen::VectorXd' The diagonal of D
+ */
+Eigen::VectorXd balanceMatrix(Eigen::MatrixXcd & A, int & sweeps)
+{
+    int n = A.rows();
+    Eigen::VectorXd D = Eigen::VectorXd::Ones(n);
+    bool done = false;
+    sweeps = 0;
+    while (!done && sweeps < BALANCE_MAX_SWEEPS) {
+        done = true;
+        sweeps++;
+        for (int i=0; i<n; i++) {
+            double c = A.col(i).cwiseAbs().sum() - std::abs(A(i,i));
+            double r = A.row(i).cwiseAbs().sum() - std::abs(A(i,i));
+            if (c == 0 || r == 0) {
+                continue;
+            }
+            double ca = A.col(i).cwiseAbs().maxCoeff();
+            double ra = A.row(i).cwiseAbs().maxCoeff();
+            double s = c + r;
+            // c, r, ca and ra follow the scaling by f
+            double f = 1;
+            double g = r / BALANCE_RADIX;
+            while (c < g && std::max({f, c, ca}) < BALANCE_SFMAX2 && std::min({r, g, ra}) > BALANCE_SFMIN2) {
+                f *= BALANCE_RADIX;
+                c *= BALANCE_RADIX;
+                ca *= BALANCE_RADIX;
+                r /= BALANCE_RADIX;
+                g /= BALANCE_RADIX;
+                ra /= BALANCE_RADIX;
+            }
+            g = c / BALANCE_RADIX;
+            while (g > r && std::max(r, ra) < BALANCE_SFMAX2 && std::min({f, c, g, ca}) > BALANCE_SFMIN2) {
+                f /= BALANCE_RADIX;
+                c /= BALANCE_RADIX;
+                g /= BALANCE_RADIX;
+                ca /= BALANCE_RADIX;
+                r *= BALANCE_RADIX;
+                ra *= BALANCE_RADIX;
+            }
+            if (c + r >= 0.95 * s) {
+                continue;
+            }
+            if ((f < 1 && D(i) < 1 && f * D(i) <= BALANCE_SFMIN1) || (f > 1 && D(i) > 1 && D(i) >= BALANCE_SFMAX1 / f)) {
+                continue;
+            }
+            done = false;
+            D(i) *= f;
+            A.row(i) /= f;
+            A.col(i) *= f;
+        }
     }
-    else if (min_pos != std::string::npos && delim_pos - min_pos == 1) {
-        real = std::stod(s.substr(0,min_pos));
-        imm = -1;
+    if (!done) {
+        std::cerr << "WARNING: Balancing did not converge in " << BALANCE_MAX_SWEEPS << " sweeps. Using the last scaling." << std::endl << std::flush;
     }
-    else if (plus_pos != std::string::npos){
-        real = std::stod(s.substr(0,plus_pos));
-        imm = std::stod(s.substr(plus_pos, delim_pos-1));
+    return D;
+}
+
+/**
+ * @brief Balancing stage between the reader and the solver.
+ * 
+ * Balances the dense input matrix, maps the warm start vectors to the balanced matrix
+ * and stores the scaling, with which the solver maps its eigenvectors back. The solver
+ * only sees the balanced matrix, so its estimated error is measured in the balanced
+ * basis. The time, the number of sweeps and the reduction of the Frobenius norm are
+ * added to the metrics.
+ * @param input 'InputData&' Input whose dense matrix is balanced, with the warm start and metrics
+ */
+void balanceInput(InputData & input)
+{
+    auto start_time = std::chrono::high_resolution_clock::now();
+    double norm_before = input.input_matrix.norm();
+    int sweeps;
+    input.scaling = balanceMatrix(input.input_matrix, sweeps);
+    double norm_after = input.input_matrix.norm();
+    if (input.initial_vectors.rows() == input.scaling.size()) {
+        input.initial_vectors = input.scaling.cwiseInverse().asDiagonal() * input.initial_vectors;
     }
-    else if (min_pos != std::string::npos && min_pos > 0) {
-        real = std::stod(s.substr(0, min_pos));
-        imm = std::stod(s.substr(min_pos, delim_pos-1));
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
+
+    input.metrics.emplace_back("Balancing Time", std::to_string(time) + " microseconds");
+    input.metrics.emplace_back("Balancing Sweeps", std::to_string(sweeps));
+    input.metrics.emplace_back("Balancing Norm Reduction", std::to_string(norm_after > 0 ? norm_before / norm_after : 1.0)
+        + " (" + std::to_string(norm_before) + " to " + std::to_string(norm_after) + ")");
+}
+
+/**
+ * @brief Check whether a matrix is Hermitian up to rounding errors
+ * @param A 'Eigen::MatrixXcd const&' The matrix to check
+ * @return 'bool' True if @f$ \|A - A^H\|_F @f$ is negligible compared to @f$ \|A\|_F @f$
+ */
+bool isHermitian(Eigen::MatrixXcd const& A)
+{
+    if (A.rows() != A.cols()) {
+        return false;
     }
-    else {
-        real = 0;
-        imm = std::stod(s.substr(0,delim_pos));
+    double diff = 0;
+    for (int j = 0; j < A.cols(); j++) {
+        for (int i = 0; i <= j; i++) {
+            diff += std::norm(A(i,j) - std::conj(A(j,i)));
+        }
     }
-    return std::complex<double>(real, imm);
+    return std::sqrt(diff) <= 100 * std::numeric_limits<double>::epsilon() * A.norm();
 }
 
 /**
@@ -220,4 +629,44 @@ void tryGenMatrix(Reader *reader) {
     }
 }
 
+/**
+ * @brief Peak resident set size of the process, the largest amount of memory it held.
+ * @return Peak memory in megabytes, 0 where it cannot be measured.
+ */
+double peakMemoryMB()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        // Bytes on macOS
+        return usage.ru_maxrss / 1e6;
+#else
+        // Kilobytes on Linux
+        return usage.ru_maxrss / 1e3;
+#endif
+    }
+#endif
+    return 0.0;
+}
+
+/// Installed allocation counter, none by default
+static AllocationCounter allocation_counter = nullptr;
+
+/**
+ * @brief Installs the counter of the heap allocations of the calling thread.
+ * @param counter The counter, nullptr to stop counting.
+ */
+void setAllocationCounter(AllocationCounter counter)
+{
+    allocation_counter = counter;
+}
 
+/**
+ * @brief Installed counter of the heap allocations of the calling thread.
+ * @return The counter, nullptr if allocations are not counted.
+ */
+AllocationCounter allocationCounter()
+{
+    return allocation_counter;
+}
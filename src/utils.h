@@ -3,6 +3,7 @@
 
 #include "Reader.h"
 #include "Solver.h"
+#include <iostream>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
@@ -17,13 +18,34 @@ using json = nlohmann::json;
  */
 Reader * createReader(std::filesystem::path config_path);
 
+/**
+ * @brief Opens and parses a configuration file.
+ * @param config_path 'std::filesystem::path' object for the path to a run's configuration file.
+ * @return JSON object with the configuration.
+ */
+json readConfig(std::filesystem::path config_path);
+
+/**
+ * @brief Extracts the solver settings shared by all the input types from a configuration.
+ * @param data JSON object with the configuration.
+ * @return InputData with the method, iterations, tolerance, method parameters and seed set, and no matrix.
+ */
+InputData readRunConfig(json const& data);
+
 /**
  * @brief Create a Solver object based off of Reader object provided
- * @param reader Reader object that contains InputData needed for solver
+ * @param reader Reader object whose InputData is moved into the solver
  * @return Solver object which points to a dynamically allocated daughter of Solver class
  */
 Solver * createSolver(Reader * reader);
 
+/**
+ * @brief Create a Solver object for the input data provided
+ * @param input InputData with the matrix or operator and the solver settings
+ * @return Solver object which points to a dynamically allocated daughter of Solver class
+ */
+Solver * createSolver(InputData input);
+
 /**
  * @brief Set default solving parameters in case they weren't provided
  * @param method String that specifies the solving method
@@ -38,12 +60,73 @@ void setDefaultVals(std::string method, json &opt_params);
  */
 std::complex<double> parseComplex(std::string s);
 
+/**
+ * @brief Create complex number from a configuration value
+ * @param value 'json' string in the format "a + bi", or real number
+ * @return 'std::complex<double>' container with the complex number
+ */
+std::complex<double> parseComplexValue(json const& value);
+
+/**
+ * @brief Lex a complex literal in the format "a + bi" in place
+ * @param first Pointer to the first character of the literal
+ * @param last Pointer past the last character that may be read
+ * @param value 'std::complex<double>&' receiving the complex number
+ * @return Pointer past the literal and the blanks following it, nullptr if the literal is invalid
+ */
+const char * lexComplex(const char * first, const char * last, std::complex<double> & value);
+
+/**
+ * @brief Check whether a matrix is Hermitian up to rounding errors
+ * @param A 'Eigen::MatrixXcd const&' The matrix to check
+ * @return 'bool' True if @f$ \|A - A^H\|_F @f$ is negligible compared to @f$ \|A\|_F @f$
+ */
+bool isHermitian(Eigen::MatrixXcd const& A);
+
+/**
+ * @brief Balances a matrix in place by a diagonal similarity with powers of two.
+ * @param A 'Eigen::MatrixXcd&' The matrix, replaced by @f$ D^{-1} A D @f$
+ * @param sweeps 'int&' Receives the number of sweeps over the rows and columns
+ * @return 'Eigen::VectorXd' The diagonal of D
+ */
+Eigen::VectorXd balanceMatrix(Eigen::MatrixXcd & A, int & sweeps);
+
+/**
+ * @brief Balancing stage between the reader and the solver.
+ * @param input 'InputData&' Input whose dense matrix is balanced, with the warm start and metrics
+ */
+void balanceInput(InputData & input);
+
 /**
  * @brief Tries to call the genMatrix method, handling exceptions
  * @param reader 'Reader *' Reader object to try
  */
 void tryGenMatrix(Reader * reader);
 
+/**
+ * @brief Peak resident set size of the process, the largest amount of memory it held.
+ * @return Peak memory in megabytes, 0 where it cannot be measured.
+ */
+double peakMemoryMB();
+
+/// Function returning the number of heap allocations made so far by the calling thread
+using AllocationCounter = std::size_t (*)();
+
+/**
+ * @brief Installs the counter of the heap allocations of the calling thread.
+ *
+ * The library never counts allocations itself, as that means replacing the allocator of the
+ * process. Programs that do, such as the tests, install their counter once at startup.
+ * @param counter The counter, nullptr to stop counting.
+ */
+void setAllocationCounter(AllocationCounter counter);
+
+/**
+ * @brief Installed counter of the heap allocations of the calling thread.
+ * @return The counter, nullptr if allocations are not counted.
+ */
+AllocationCounter allocationCounter();
+
 /**
  * @brief Helper function to set a missing parameter to fixed default one
  * @param data 'const json&' The json config file
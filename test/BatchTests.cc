@@ -0,0 +1,146 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include "BatchRunner.h"
+#include "ImagePipeline.h"
+#include "ThreadPool.h"
+#include "Exceptions.h"
+#include "utils.h"
+
+// Thread pool: every task runs once, including tasks submitted by other tasks
+TEST(ThreadPool, RunsAllTasks) {
+    std::atomic<int> count(0);
+    {
+        ThreadPool pool(3);
+        for (int t=0; t<100; t++) {
+            pool.submit([&pool, &count, t]() {
+                count++;
+                if (t % 10 == 0) {
+                    pool.submit([&count]() { count++; });
+                }
+            });
+        }
+        pool.wait();
+        EXPECT_EQ(count, 110);
+    }
+}
+
+// Same seed gives the same run, whatever the thread it runs on
+TEST(ThreadPool, SeededSolversAreReproducible) {
+    InputData input;
+    input.input_matrix = Eigen::MatrixXcd::Identity(50, 50);
+    input.input_matrix.diagonal().setLinSpaced(50, 1.0, 2.0);
+    input.size = 50;
+    input.num_iters = 30;
+    input.tol = 1e-12;
+    input.method_config["SHIFT"] = "0";
+    input.seed = 42;
+
+    PowerSolver reference(input);
+    reference.solve();
+
+    std::vector<OutputData> outputs(8);
+    {
+        ThreadPool pool(4);
+        for (int t=0; t<8; t++) {
+            pool.submit([&input, &outputs, t]() {
+                PowerSolver solver(input);
+                solver.solve();
+                outputs[t] = solver.getOutput();
+            });
+        }
+    }
+    for (auto const& out : outputs) {
+        EXPECT_EQ(out.estimated_eigenvalues[0], reference.getOutput().estimated_eigenvalues[0]);
+    }
+}
+
+// Directory batch: jobs are sorted, failures are recorded without stopping the batch
+TEST(BatchRunner, Directory) {
+    BatchRunner batch("../test/BatchTests", 2);
+    batch.run();
+    std::vector<BatchResult> results = batch.getResults();
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(batch.numFailed(), 1);
+
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(results[0].config.filename(), "job1_qr.json");
+    EXPECT_EQ(results[0].output.estimated_eigenvalues.size(), 2);
+
+    EXPECT_TRUE(results[1].success);
+    EXPECT_NEAR(std::abs(results[1].output.estimated_eigenvalues[0] - 4.0), 0.0, 1e-8);
+
+    EXPECT_FALSE(results[2].success);
+    EXPECT_NE(results[2].error.find("Configuration File error"), std::string::npos);
+
+    batch.saveOutput("./batch_output_test.csv");
+    std::ifstream csv("./batch_output_test.csv");
+    std::string line;
+    int rows = 0;
+    while (std::getline(csv, line)) {
+        rows++;
+    }
+    // Header, two QR eigenvalues, one power eigenvalue and one failed job
+    EXPECT_EQ(rows, 5);
+}
+
+// Manifest batch: comments and blank lines are skipped, paths are relative to the manifest
+TEST(BatchRunner, Manifest) {
+    BatchRunner batch("../test/BatchTests/manifest.txt", 0);
+    batch.run();
+    std::vector<BatchResult> results = batch.getResults();
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(batch.numFailed(), 0);
+    EXPECT_EQ(results[0].config.filename(), "job2_power.json");
+}
+
+// Missing batch
+TEST(BatchRunner, MissingManifest) {
+    EXPECT_THROW(BatchRunner("../test/BatchTests/missing.txt", 1), ConfigError);
+}
+
+// Image pipeline over a directory: every image gets a result, undecodable ones fail alone
+TEST(ImagePipeline, Directory) {
+    ImagePipeline pipeline("../test/BatchTests/pipeline/directory.json");
+    pipeline.run();
+    std::vector<BatchResult> results = pipeline.getResults();
+    ASSERT_EQ(results.size(), 4);
+    EXPECT_EQ(pipeline.numFailed(), 1);
+    for (int f=0; f<3; f++) {
+        EXPECT_TRUE(results[f].success);
+        EXPECT_EQ(results[f].output.estimated_eigenvalues.size(), 16);
+    }
+    EXPECT_EQ(results[3].config.filename(), "frame_4.png");
+    EXPECT_NE(results[3].error.find("Reader error"), std::string::npos);
+
+    // Eigenvalues of the identity-like first frame: 190 (15 times) and 190 + 16 * 10
+    std::complex<double> largest = *std::max_element(results[0].output.estimated_eigenvalues.begin(),
+        results[0].output.estimated_eigenvalues.end(), [](auto a, auto b) { return a.real() < b.real(); });
+    EXPECT_NEAR(largest.real(), 350.0, 1e-6);
+
+    // Images of the same size reuse the two buffers
+    std::vector<std::pair<std::string, std::string>> metrics = pipeline.getMetrics();
+    auto allocations = std::find_if(metrics.begin(), metrics.end(), [](auto const& m) { return m.first == "Buffer Allocations"; });
+    ASSERT_NE(allocations, metrics.end());
+    EXPECT_LE(std::stoi(allocations->second), 2);
+    EXPECT_NE(std::find_if(metrics.begin(), metrics.end(), [](auto const& m) { return m.first == "Solve Utilization"; }), metrics.end());
+}
+
+// Image pipeline over a pattern, with the images downsampled
+TEST(ImagePipeline, Pattern) {
+    ImagePipeline pipeline("../test/BatchTests/pipeline/pattern.json");
+    pipeline.run();
+    std::vector<BatchResult> results = pipeline.getResults();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(results[0].config.filename(), "frame_3.png");
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(results[0].output.estimated_eigenvalues.size(), 8);
+}
+
+// A single picture is not a set, and a set is refused by the single-picture reader
+TEST(ImagePipeline, NotASet) {
+    EXPECT_THROW(ImagePipeline("../test/ReaderTests/picture_pyramid.json"), ConfigError);
+    EXPECT_THROW(createReader("../test/BatchTests/pipeline/directory.json"), ConfigError);
+}
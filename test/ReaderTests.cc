@@ -1,8 +1,15 @@
+#include <algorithm>
 #include <cmath>
 #include <gtest/gtest.h>
 #include <complex>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <limits>
 #include "utils.h"
 #include "Exceptions.h"
+#include "BinaryMatrix.h"
+#include "ToeplitzOperator.h"
 
 // Test 1: 2x2 real matrix
 TEST(createReader, Test1) {
@@ -150,3 +157,435 @@ TEST(createReader, Cropping) {
         });
 }
 
+
+// Test 14: Sparse coordinate file, duplicates are summed
+TEST(createReader, Sparse_Matrix) {
+    Eigen::MatrixXcd expected_matrix(3, 3);
+    expected_matrix << std::complex<double>(4, 0),   std::complex<double>(0, 0), std::complex<double>(1, -2),
+                       std::complex<double>(0, 0),   std::complex<double>(5, 0), std::complex<double>(0, 0),
+                       std::complex<double>(2.5, 0), std::complex<double>(0, 0), std::complex<double>(1, 1);
+    InputData input = createReader("../test/ReaderTests/sparse1.json")->getInputData();
+    EXPECT_EQ(input.size, 3);
+    EXPECT_EQ(input.input_matrix.size(), 0);
+    ASSERT_TRUE(input.op);
+    EXPECT_EQ(input.op->toDense(), expected_matrix);
+}
+
+// Test 15: Sparse entry out of range
+TEST(createReader, Sparse_Out_Of_Range) {
+    EXPECT_THROW(createReader("../test/ReaderTests/sparse_out_of_range.json"),
+        ReaderError);
+}
+
+// Test 16: Complex literal formats, blanks, exponents and CRLF line endings
+TEST(createReader, CSV_Formats) {
+    Eigen::MatrixXcd expected_matrix(3, 3);
+    expected_matrix << std::complex<double>(1, 0), std::complex<double>(-0.25, 3), std::complex<double>(0, 1),
+                       std::complex<double>(4, -1), std::complex<double>(0, 5.5), std::complex<double>(-600, -0.5),
+                       std::complex<double>(7, 0), std::complex<double>(8, 9), std::complex<double>(0, -1);
+    EXPECT_EQ(createReader("../test/ReaderTests/csv_formats.json")->getInputData().input_matrix,
+        expected_matrix);
+}
+
+// Test 17: Row with more columns than the first one
+TEST(createReader, CSV_Extra_Column) {
+    EXPECT_THROW(createReader("../test/ReaderTests/extra_column.json"),
+        ReaderError);
+}
+
+// Test 18: Complex literals lexed in place
+TEST(parseComplex, Literals) {
+    EXPECT_EQ(parseComplex("5 + 3i"), std::complex<double>(5, 3));
+    EXPECT_EQ(parseComplex("-2"), std::complex<double>(-2, 0));
+    EXPECT_EQ(parseComplex("1e-3-2e+1i"), std::complex<double>(1e-3, -20));
+    EXPECT_EQ(parseComplex("-i"), std::complex<double>(0, -1));
+    EXPECT_EQ(parseComplex("3 - i"), std::complex<double>(3, -1));
+    EXPECT_THROW(parseComplex("3 + "), std::invalid_argument);
+    EXPECT_THROW(parseComplex("--3"), std::invalid_argument);
+    EXPECT_THROW(parseComplex("3x"), std::invalid_argument);
+}
+
+// Test 19: Invalid cell reported with its row and column
+TEST(createReader, CSV_Invalid_Cell) {
+    try {
+        createReader("../test/ReaderTests/invalid_cell.json");
+        FAIL() << "Expected ReaderError";
+    }
+    catch (const ReaderError &e) {
+        EXPECT_STREQ(e.what(), "Invalid number at row 1, column 1");
+    }
+}
+
+// Test 20: Parallel parsing of a large file gives the same matrix and the first error
+TEST(FileReader, Parallel_Chunks) {
+    int n = 300;
+    Eigen::MatrixXcd expected_matrix(n, n);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pcsc_parallel_test.csv";
+    {
+        std::ofstream out(path);
+        out.precision(17);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                expected_matrix(i, j) = std::complex<double>(i * 1000.0 + j + 0.123456789, j / 7.0);
+                out << expected_matrix(i, j).real() << " + " << expected_matrix(i, j).imag() << "i" << (j + 1 < n ? ", " : "\r\n");
+            }
+        }
+    }
+    // Large enough to be split in several chunks
+    ASSERT_GT(std::filesystem::file_size(path), 3 << 20);
+    for (int threads : {1, 3, 8}) {
+        FileReader reader("QR", 1, 1e-9, nlohmann::json(), path.string(), threads);
+        reader.genMatrix();
+        EXPECT_EQ(reader.getInputData().input_matrix, expected_matrix);
+    }
+
+    // Errors in several chunks, the first row is reported
+    std::string content;
+    {
+        std::ifstream in(path);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    for (int row : {250, 120}) {
+        size_t pos = 0;
+        for (int r = 0; r < row; r++) {
+            pos = content.find('\n', pos) + 1;
+        }
+        content[content.find(',', pos) + 2] = '?';
+    }
+    {
+        std::ofstream out(path);
+        out << content;
+    }
+    FileReader reader("QR", 1, 1e-9, nlohmann::json(), path.string(), 4);
+    try {
+        reader.genMatrix();
+        FAIL() << "Expected ReaderError";
+    }
+    catch (const ReaderError &e) {
+        EXPECT_STREQ(e.what(), "Invalid number at row 120, column 1");
+    }
+    std::filesystem::remove(path);
+}
+
+// Test 21: Binary real row-major matrix, mapped without copy
+TEST(createReader, Binary_Matrix) {
+    Eigen::MatrixXcd expected_matrix(2, 2);
+    expected_matrix << std::complex<double>(1, 0), std::complex<double>(2, 0),
+                       std::complex<double>(3, 0), std::complex<double>(4, 0);
+    InputData input = createReader("../test/ReaderTests/binary_rowmajor.json")->getInputData();
+    EXPECT_EQ(input.size, 2);
+    EXPECT_EQ(input.input_matrix.size(), 0);
+    ASSERT_TRUE(input.op);
+    EXPECT_EQ(input.op->toDense(), expected_matrix);
+}
+
+// Test 22: File without binary matrix header
+TEST(createReader, Binary_Invalid) {
+    EXPECT_THROW(createReader("../test/ReaderTests/binary_invalid.json"),
+        ReaderError);
+}
+
+// Test 23: Binary round trip of a complex matrix, operator products match the dense matrix
+TEST(BinaryFileReader, Round_Trip) {
+    Eigen::MatrixXcd A = Eigen::MatrixXcd::Random(40, 40);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pcsc_binary_test.bin";
+    for (bool real : {false, true}) {
+        Eigen::MatrixXcd expected_matrix = real ? Eigen::MatrixXcd(A.real().cast<std::complex<double>>()) : A;
+        writeBinaryMatrix(A, path.string(), real);
+        BinaryFileReader reader("POWER", 1, 1e-9, nlohmann::json(), path.string());
+        reader.genMatrix();
+        InputData input = reader.getInputData();
+        ASSERT_TRUE(input.op);
+        EXPECT_EQ(input.op->toDense(), expected_matrix);
+
+        Eigen::MatrixXcd X = Eigen::MatrixXcd::Random(40, 3), Y(40, 3);
+        Eigen::VectorXcd y(40);
+        input.op->applyBlock(X, Y);
+        input.op->apply(X.col(0), y);
+        EXPECT_LT((Y - expected_matrix * X).norm(), 1e-12);
+        EXPECT_LT((y - expected_matrix * X.col(0)).norm(), 1e-12);
+    }
+    std::filesystem::remove(path);
+}
+
+// Test 24: Matrix Market coordinate files, the other triangle is filled in
+TEST(createReader, MTX_Coordinate) {
+    Eigen::MatrixXcd symmetric(3, 3);
+    symmetric << std::complex<double>(4, 0),    std::complex<double>(-1.5, 0), std::complex<double>(0, 0),
+                 std::complex<double>(-1.5, 0), std::complex<double>(0, 0),    std::complex<double>(1, 0),
+                 std::complex<double>(0, 0),    std::complex<double>(1, 0),    std::complex<double>(2, 0);
+    InputData input = createReader("../test/ReaderTests/mtx_symmetric.json")->getInputData();
+    ASSERT_TRUE(input.op);
+    EXPECT_EQ(input.op->toDense(), symmetric);
+    EXPECT_TRUE(input.hermitian);
+
+    Eigen::MatrixXcd hermitian(3, 3);
+    hermitian << std::complex<double>(2, 0), std::complex<double>(1, 1),  std::complex<double>(0, 0),
+                 std::complex<double>(1, -1), std::complex<double>(3, 0), std::complex<double>(0, 0),
+                 std::complex<double>(0, 0), std::complex<double>(0, 0),  std::complex<double>(-1, 0);
+    input = createReader("../test/ReaderTests/mtx_hermitian.json")->getInputData();
+    EXPECT_EQ(input.op->toDense(), hermitian);
+    EXPECT_TRUE(input.hermitian);
+
+    Eigen::MatrixXcd pattern(2, 2);
+    pattern << std::complex<double>(0, 0), std::complex<double>(1, 0),
+               std::complex<double>(1, 0), std::complex<double>(1, 0);
+    input = createReader("../test/ReaderTests/mtx_pattern.json")->getInputData();
+    EXPECT_EQ(input.op->toDense(), pattern);
+    EXPECT_FALSE(input.hermitian);
+}
+
+// Test 25: Matrix Market array file, stored column-major
+TEST(createReader, MTX_Array) {
+    Eigen::MatrixXcd expected_matrix(2, 2);
+    expected_matrix << std::complex<double>(1, 0), std::complex<double>(2, -1),
+                       std::complex<double>(3, 1), std::complex<double>(4, 0);
+    InputData input = createReader("../test/ReaderTests/mtx_array.json")->getInputData();
+    EXPECT_FALSE(input.op);
+    EXPECT_EQ(input.input_matrix, expected_matrix);
+}
+
+// Test 26: Matrix Market entry out of range
+TEST(createReader, MTX_Out_Of_Range) {
+    EXPECT_THROW(createReader("../test/ReaderTests/mtx_out_of_range.json"),
+        ReaderError);
+}
+
+// Test 27: Hermitian header selects the Hermitian solver
+TEST(createSolver, MTX_Hermitian_Hint) {
+    Reader * reader = createReader("../test/ReaderTests/mtx_hermitian.json");
+    Solver * solver = createSolver(reader);
+    solver->solve();
+    EXPECT_EQ(solver->getOutput().method, "Hermitian Divide-and-Conquer Method");
+    delete solver;
+    delete reader;
+}
+
+// Test 28: Out-of-core streaming in blocks smaller than the matrix, products match the dense matrix
+TEST(BinaryFileReader, Out_Of_Core) {
+    Eigen::MatrixXcd A = Eigen::MatrixXcd::Random(40, 40);
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pcsc_out_of_core_test.bin";
+    for (bool real : {false, true}) {
+        Eigen::MatrixXcd expected_matrix = real ? Eigen::MatrixXcd(A.real().cast<std::complex<double>>()) : A;
+        writeBinaryMatrix(A, path.string(), real);
+        // Budget of two blocks of 7 columns, the last block is shorter
+        std::size_t budget = 2 * 7 * 40 * (real ? sizeof(double) : sizeof(std::complex<double>));
+        OutOfCoreOperator op(path.string(), budget);
+        EXPECT_EQ(op.getBlockSize(), 7);
+        EXPECT_EQ(op.toDense(), expected_matrix);
+
+        Eigen::MatrixXcd X = Eigen::MatrixXcd::Random(40, 3), Y(40, 3);
+        Eigen::VectorXcd y(40);
+        op.applyBlock(X, Y);
+        op.apply(X.col(0), y);
+        EXPECT_LT((Y - expected_matrix * X).norm(), 1e-12);
+        EXPECT_LT((y - expected_matrix * X.col(0)).norm(), 1e-12);
+    }
+    std::filesystem::remove(path);
+
+    // Row-major file streamed one row at a time by the power method
+    Reader * reader = createReader("../test/ReaderTests/binary_out_of_core.json");
+    Solver * solver = createSolver(reader);
+    solver->solve();
+    OutputData output = solver->getOutput();
+    EXPECT_NEAR(output.estimated_eigenvalues[0].real(), (5 + std::sqrt(33.0)) / 2, 1e-8);
+    EXPECT_TRUE(std::any_of(output.metrics.begin(), output.metrics.end(),
+        [](auto const& metric) { return metric.first == "Stream Throughput"; }));
+    delete solver;
+    delete reader;
+}
+
+// Test 29: Function generated on several threads, upper triangle mirrored with the symmetry hint
+TEST(FunctionReader, Parallel_Symmetric) {
+    Eigen::MatrixXcd expected_matrix(150, 150);
+    for (int row = 0; row < 150; row++) {
+        for (int col = 0; col < 150; col++) {
+            double i = row + 1, j = col + 1;
+            expected_matrix(row, col) = i * j + 1 / (i + j);
+        }
+    }
+    InputData input = createReader("../test/ReaderTests/function_symmetric.json")->getInputData();
+    EXPECT_EQ(input.input_matrix, expected_matrix);
+    EXPECT_TRUE(input.hermitian);
+    ASSERT_FALSE(input.metrics.empty());
+    EXPECT_EQ(input.metrics[0].first, "Generation Time");
+
+    FunctionReader reader("QR", 1, 1e-9, nlohmann::json(), "i * j + 1 / (i + j)", 150, false, 4);
+    reader.genMatrix();
+    EXPECT_EQ(reader.getInputData().input_matrix, expected_matrix);
+    EXPECT_FALSE(reader.getInputData().hermitian);
+
+    FunctionReader invalid("QR", 1, 1e-9, nlohmann::json(), "i * (j", 10);
+    EXPECT_THROW(invalid.genMatrix(), ReaderError);
+}
+
+// Test 30: Matrix-free function input, the entries are evaluated during the products
+TEST(FunctionReader, Matrix_Free) {
+    Eigen::MatrixXd hilbert(300, 300);
+    for (int row = 0; row < 300; row++) {
+        for (int col = 0; col < 300; col++) {
+            hilbert(row, col) = 1.0 / (row + col + 1);
+        }
+    }
+    Eigen::MatrixXcd expected_matrix = hilbert.cast<std::complex<double>>();
+    Reader * reader = createReader("../test/ReaderTests/function_matrix_free.json");
+    InputData input = reader->getInputData();
+    EXPECT_EQ(input.input_matrix.size(), 0);
+    ASSERT_TRUE(input.op);
+    EXPECT_EQ(input.op->toDense(), expected_matrix);
+
+    Eigen::MatrixXcd X = Eigen::MatrixXcd::Random(300, 3), Y(300, 3);
+    input.op->applyBlock(X, Y);
+    EXPECT_LT((Y - expected_matrix * X).norm(), 1e-12);
+
+    Solver * solver = createSolver(reader);
+    solver->solve();
+    OutputData output = solver->getOutput();
+    double largest = Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(hilbert).eigenvalues().maxCoeff();
+    EXPECT_NEAR(output.estimated_eigenvalues[0].real(), largest, 1e-8);
+    EXPECT_TRUE(std::any_of(output.metrics.begin(), output.metrics.end(),
+        [](auto const& metric) { return metric.first == "Matvec Throughput"; }));
+    delete solver;
+    delete reader;
+}
+
+// Test 31: Toeplitz function detected by probing, FFT-based products match the dense matrix
+TEST(FunctionReader, Toeplitz_Structure) {
+    Eigen::MatrixXcd expected_matrix(37, 37);
+    for (int row = 0; row < 37; row++) {
+        for (int col = 0; col < 37; col++) {
+            expected_matrix(row, col) = std::exp(-std::abs(row - col)) + (row > col ? 0.5 : 0.0);
+        }
+    }
+    Reader * reader = createReader("../test/ReaderTests/function_toeplitz.json");
+    InputData input = reader->getInputData();
+    EXPECT_EQ(input.input_matrix.size(), 0);
+    auto toeplitz = std::dynamic_pointer_cast<ToeplitzOperator>(input.op);
+    ASSERT_TRUE(toeplitz);
+    EXPECT_FALSE(toeplitz->isCirculant());
+    EXPECT_LT((toeplitz->toDense() - expected_matrix).norm(), 1e-14);
+
+    Eigen::VectorXcd x = Eigen::VectorXcd::Random(37), y(37);
+    toeplitz->apply(x, y);
+    EXPECT_LT((y - expected_matrix * x).norm(), 1e-12);
+
+    // A function of i and j separately is not Toeplitz
+    FunctionReader generic("POWER", 1, 1e-9, nlohmann::json(), "i * j", 37, false, 0, false, "AUTO");
+    generic.genMatrix();
+    EXPECT_FALSE(generic.getInputData().op);
+    EXPECT_EQ(generic.getInputData().input_matrix.size(), 37 * 37);
+    delete reader;
+}
+
+// Test 32: Circulant function, all eigenvalues from the FFT of the first column
+TEST(createSolver, Circulant_FFT) {
+    Eigen::MatrixXcd A(30, 30);
+    for (int row = 0; row < 30; row++) {
+        for (int col = 0; col < 30; col++) {
+            A(row, col) = 1 + (row - col + 30) % 30;
+        }
+    }
+    Reader * reader = createReader("../test/ReaderTests/function_circulant.json");
+    Solver * solver = createSolver(reader);
+    solver->solve();
+    OutputData output = solver->getOutput();
+    EXPECT_EQ(output.method, "Circulant FFT Method");
+    EXPECT_LT(output.estimated_error, 1e-10);
+
+    // Every eigenvalue of the dense matrix is found by the FFT
+    Eigen::VectorXcd expected = Eigen::ComplexEigenSolver<Eigen::MatrixXcd>(A).eigenvalues();
+    ASSERT_EQ(output.estimated_eigenvalues.size(), 30);
+    for (int k = 0; k < 30; k++) {
+        EXPECT_LT((output.estimated_eigenvalues.array() - expected(k)).abs().minCoeff(), 1e-9);
+    }
+    delete solver;
+    delete reader;
+}
+
+// Test 33: Picture pyramid solved from coarse to fine
+TEST(createSolver, Picture_Pyramid) {
+    Reader * reader = createReader("../test/ReaderTests/picture_pyramid.json");
+    InputData input = reader->getInputData();
+    EXPECT_EQ(input.size, 128);
+    EXPECT_EQ(input.input_matrix.rows(), 128);
+    ASSERT_EQ(input.coarse_levels.size(), 2);
+    EXPECT_EQ(input.coarse_levels[0].rows(), 32);
+    EXPECT_EQ(input.coarse_levels[1].rows(), 64);
+
+    Solver * solver = createSolver(reader);
+    solver->solve();
+    OutputData output = solver->getOutput();
+    EXPECT_LT(output.estimated_error, 1e-8 * 10);
+    EXPECT_TRUE(std::any_of(output.metrics.begin(), output.metrics.end(),
+        [](auto const& metric) { return metric.first == "Level 3 (128x128)"; }));
+
+    // Same dominant eigenvalue as a direct solve of the finest level
+    input.coarse_levels.clear();
+    PowerSolver direct(input);
+    direct.solve();
+    EXPECT_NEAR(std::abs(output.estimated_eigenvalues[0] - direct.getOutput().estimated_eigenvalues[0]), 0, 1e-6);
+
+    // The level matrices are given back, so a second solve runs on the same levels
+    solver->solve();
+    OutputData again = solver->getOutput();
+    EXPECT_LT(again.estimated_error, 1e-8 * 10);
+    EXPECT_NEAR(std::abs(again.estimated_eigenvalues[0] - output.estimated_eigenvalues[0]), 0, 1e-6);
+    // Its metrics replace those of the first solve
+    ASSERT_EQ(again.metrics.size(), output.metrics.size());
+    EXPECT_EQ(std::count_if(again.metrics.begin(), again.metrics.end(),
+        [](auto const& metric) { return metric.first == "Level 3 (128x128)"; }), 1);
+    delete solver;
+    delete reader;
+}
+
+// Test 34: Invalid multi-shift settings are configuration errors of the solver
+TEST(createSolver, MultiShift_Invalid_Shifts) {
+    for (std::string config : {"multishift_empty_shifts.json", "multishift_bad_grid.json"}) {
+        Reader * reader = createReader("../test/ReaderTests/" + config);
+        EXPECT_THROW(createSolver(reader), ConfigError) << config;
+        delete reader;
+    }
+}
+
+// Test 35: Corrupt binary sizes are rejected without overflowing the size check
+TEST(BinaryFileReader, Corrupt_Size) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pcsc_corrupt_size_test.bin";
+    for (std::int64_t rows : {std::int64_t(1) << 31, std::int64_t(std::numeric_limits<int>::max()), std::int64_t(1) << 40}) {
+        BinaryMatrixHeader header = {};
+        std::memcpy(header.magic, BINARY_MATRIX_MAGIC, sizeof(header.magic));
+        header.version = BINARY_MATRIX_VERSION;
+        header.dtype = COMPLEX128;
+        header.layout = COLUMN_MAJOR;
+        header.rows = header.cols = rows;
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(std::string(64, '\0').data(), 64);
+        out.close();
+        EXPECT_THROW(mapBinaryMatrix(path.string()), ReaderError) << rows;
+        EXPECT_THROW(OutOfCoreOperator(path.string(), 1 << 20), ReaderError) << rows;
+    }
+    std::filesystem::remove(path);
+}
+
+// Test 36: The symmetry hint mirrors the upper triangle of matrix-free functions as of dense ones
+TEST(FunctionReader, Matrix_Free_Symmetric) {
+    std::string func = "i * i + 2 * j + 1 / (i + j)";
+    FunctionReader dense("POWER", 1, 1e-9, nlohmann::json(), func, 300, true, 2);
+    dense.genMatrix();
+    Eigen::MatrixXcd expected_matrix = dense.getInputData().input_matrix;
+    EXPECT_EQ(expected_matrix, expected_matrix.transpose());
+
+    FunctionReader matrix_free("POWER", 1, 1e-9, nlohmann::json(), func, 300, true, 2, true);
+    matrix_free.genMatrix();
+    InputData input = matrix_free.getInputData();
+    ASSERT_TRUE(input.op);
+    EXPECT_TRUE(input.hermitian);
+    EXPECT_EQ(input.op->toDense(), expected_matrix);
+
+    Eigen::VectorXcd x = Eigen::VectorXcd::Random(300), y(300);
+    input.op->apply(x, y);
+    EXPECT_LT((y - expected_matrix * x).norm(), 1e-9 * expected_matrix.norm());
+    Eigen::MatrixXcd X = Eigen::MatrixXcd::Random(300, 3), Y(300, 3);
+    input.op->applyBlock(X, Y);
+    EXPECT_LT((Y - expected_matrix * X).norm(), 1e-9 * expected_matrix.norm());
+}
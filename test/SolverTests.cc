@@ -1,49 +1,14 @@
 #include <cmath>
+#include <algorithm>
 #include <gtest/gtest.h>
 #include "Solver.h"
 #include "test_utils.h"
 #include <Eigen/Eigenvalues>
 #include <tuple>
+#include <type_traits>
 #include <string>
 #include "utils.h"
-
-class Matrices
-{
-    public:
-        Matrices() {  
-            A_random3 = Eigen::MatrixXcd::Random(3, 3);
-            A_random5 = Eigen::MatrixXcd::Random(5, 5);
-            A_identity = Eigen::MatrixXcd::Identity(3, 3);
-            A_diagonal_real = Eigen::MatrixXcd::Zero(3, 3);
-            A_diagonal_real.diagonal() << Eigen::dcomplex(1.0, 0.0), 
-                Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(3.0, 0.0);
-            A_diagonal_complex = Eigen::MatrixXcd::Zero(3, 3);
-            A_diagonal_complex.diagonal() << Eigen::dcomplex(1.0, 1.0), 
-                Eigen::dcomplex(2.0, 7.0), Eigen::dcomplex(3.0, 4.0);
-            A_symmetric = Eigen::MatrixXcd::Zero(4,4);
-            A_symmetric << Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(3.0, 0.0), Eigen::dcomplex(1.0, 0.0), Eigen::dcomplex(4.0, 0.0),
-                           Eigen::dcomplex(3.0, 0.0), Eigen::dcomplex(5.0, 0.0), Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(6.0, 0.0),
-                           Eigen::dcomplex(1.0, 0.0), Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(8.0, 0.0), Eigen::dcomplex(7.0, 0.0),
-                           Eigen::dcomplex(4.0, 0.0), Eigen::dcomplex(6.0, 0.0), Eigen::dcomplex(7.0, 0.0), Eigen::dcomplex(9.0, 0.0);
-            
-        }
-        // Get matrices
-        Eigen::MatrixXcd getRandom3() const { return A_random3; }
-        Eigen::MatrixXcd getRandom5() const { return A_random5; }
-        Eigen::MatrixXcd getIdentity() const { return A_identity; }
-        Eigen::MatrixXcd getDiagonalReal() const { return A_diagonal_real; }
-        Eigen::MatrixXcd getDiagonalComplex() const { return A_diagonal_complex; }
-        Eigen::MatrixXcd getSymmetric() const { return A_symmetric; }
-
-    protected:
-        Eigen::MatrixXcd A_random3;
-        Eigen::MatrixXcd A_random5;
-        Eigen::MatrixXcd A_identity;
-        Eigen::MatrixXcd A_diagonal_real;
-        Eigen::MatrixXcd A_diagonal_flipped;
-        Eigen::MatrixXcd A_diagonal_complex;
-        Eigen::MatrixXcd A_symmetric;
-};
+#include "Exceptions.h"
 
 class QRSolverTest : public Matrices, public ::testing::TestWithParam<Eigen::MatrixXcd> {
 protected:
@@ -68,6 +33,41 @@ protected:
         }
         else { sign = "+"; }
     }
+    // Runs the power and inverse methods with the shift and an acceleration, checks that they find
+    // the largest and smallest eigenvalues of the shifted matrix and returns their outputs
+    std::pair<OutputData, OutputData> solveAndCheck(std::string const& acceleration)
+    {
+        int n = matrix.rows();
+        Eigen::MatrixXcd shifted_matrix = matrix - shift*Eigen::MatrixXcd::Identity(n,n);
+
+        // Input setup
+        std::string complex_shift = std::to_string(shift.real()) + sign + std::to_string(shift.imag()) + "i";
+        input.method_config["SHIFT"] = complex_shift;
+        input.method_config["ACCELERATION"] = acceleration;
+        input.input_matrix = matrix;
+        input.size = n;
+
+        // True eigenvalues
+        Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(shifted_matrix);
+        std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
+        Eigen::dcomplex largest = sorted_eigenvals[0];
+        Eigen::dcomplex smallest = sorted_eigenvals.back();
+
+        // Power Solver
+        PowerSolver powerSolver(input);
+        powerSolver.solve();
+        Eigen::dcomplex eigenval = powerSolver.getOutput().estimated_eigenvalues[0];
+        EXPECT_NEAR(eigenval.real(), largest.real() + shift.real(), 1e-2) << acceleration;
+        EXPECT_NEAR(eigenval.imag(), largest.imag() + shift.imag(), 1e-2) << acceleration;
+
+        // Inverse Solver
+        InverseSolver invSolver(input);
+        invSolver.solve();
+        eigenval = invSolver.getOutput().estimated_eigenvalues[0];
+        EXPECT_NEAR(eigenval.real(), smallest.real() + shift.real(), 1e-2) << acceleration;
+        EXPECT_NEAR(eigenval.imag(), smallest.imag() + shift.imag(), 1e-2) << acceleration;
+        return {powerSolver.getOutput(), invSolver.getOutput()};
+    }
     Eigen::MatrixXcd matrix;
     Eigen::dcomplex shift;
     std::string sign;
@@ -76,37 +76,52 @@ protected:
 
 TEST_P(PowerBasedSolverTest, SolverWithShiftOption) 
 {
-    int n = matrix.rows();
-    Eigen::MatrixXcd shifted_matrix = matrix - shift*Eigen::MatrixXcd::Identity(n,n);
+    solveAndCheck("NONE");
+}
+
+TEST_P(PowerBasedSolverTest, AitkenExtrapolation)
+{
+    auto [plain_power, plain_inverse] = solveAndCheck("NONE");
+    auto [power, inverse] = solveAndCheck("AITKEN");
+    for (auto const& [out, plain] : {std::make_pair(power, plain_power), std::make_pair(inverse, plain_inverse)}) {
+        // Same start as without acceleration, the extrapolation can only stop earlier
+        EXPECT_LE(out.iterations, plain.iterations);
+        // The error is the residual of the eigenvector, the extrapolation gap is reported apart
+        Eigen::VectorXcd v = out.estimated_eigenvectors.col(0);
+        Eigen::dcomplex quotient = v.dot(matrix*v) / v.squaredNorm();
+        EXPECT_NEAR(out.estimated_error, (matrix*v - quotient*v).norm(), 1e-10);
+        EXPECT_EQ(metricValue(out, "Acceleration"), "AITKEN");
+        EXPECT_FALSE(metricValue(out, "Extrapolation Gap").empty());
+    }
+}
 
+TEST_P(QRSolverTest, SolverQR) 
+{
     // Input setup
-    std::string complex_shift = std::to_string(shift.real()) + sign + std::to_string(shift.imag()) + "i";
-    input.method_config["SHIFT"] = complex_shift;
+    int n = matrix.rows();
     input.input_matrix = matrix;
     input.size = n;
-    
+
     // True eigenvalues
-    Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(shifted_matrix);
+    Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(matrix);
     std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
-    Eigen::dcomplex largest = sorted_eigenvals[0];
-    Eigen::dcomplex smallest = sorted_eigenvals.back();
 
     // Power Solver
-    PowerSolver powerSolver(input);
-    powerSolver.solve();
-    Eigen::dcomplex eigenval = powerSolver.getOutput().estimated_eigenvalues[0];
-    EXPECT_NEAR(eigenval.real(), largest.real() + shift.real(), 1e-2); 
-    EXPECT_NEAR(eigenval.imag(), largest.imag() + shift.imag(), 1e-2); 
+    QRSolver qrSolver(input);
+    qrSolver.solve();
+    Eigen::VectorXcd eigenvals = qrSolver.getOutput().estimated_eigenvalues;
 
-    // Inverse Solver
-    InverseSolver invSolver(input);
-    invSolver.solve();
-    eigenval = invSolver.getOutput().estimated_eigenvalues[0];
-    EXPECT_NEAR(eigenval.real(), smallest.real() + shift.real(), 1e-2); 
-    EXPECT_NEAR(eigenval.imag(), smallest.imag() + shift.imag(), 1e-2); 
+    // Sort eigenvaluess from QR solver
+    std::vector<Eigen::dcomplex> sorted_qr = sort_eigenvalues(eigenvals);
+
+    for (int i=0; i<n; i++)
+    {
+        EXPECT_NEAR(sorted_qr[i].real(), sorted_eigenvals[i].real(), 1e-2);
+        EXPECT_NEAR(sorted_qr[i].imag(), sorted_eigenvals[i].imag(), 1e-2);
+    }
 }
 
-TEST_P(QRSolverTest, SolverQR) 
+TEST_P(QRSolverTest, SolverShiftedQR)
 {
     // Input setup
     int n = matrix.rows();
@@ -117,13 +132,10 @@ TEST_P(QRSolverTest, SolverQR)
     Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(matrix);
     std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
 
-    // Power Solver
-    QRSolver qrSolver(input);
+    // Shifted QR Solver
+    ShiftedQRSolver qrSolver(input);
     qrSolver.solve();
-    Eigen::VectorXcd eigenvals = qrSolver.getOutput().estimated_eigenvalues;
-
-    // Sort eigenvaluess from QR solver
-    std::vector<Eigen::dcomplex> sorted_qr = sort_eigenvalues(eigenvals);
+    std::vector<Eigen::dcomplex> sorted_qr = sort_eigenvalues(qrSolver.getOutput().estimated_eigenvalues);
 
     for (int i=0; i<n; i++)
     {
@@ -132,6 +144,742 @@ TEST_P(QRSolverTest, SolverQR)
     }
 }
 
+TEST(ShiftedQRSolver, LargeRandomMatrix)
+{
+    int n = 100;
+    InputData input;
+    input.num_iters = 2000;
+    input.tol = 1e-12;
+    input.input_matrix = Eigen::MatrixXcd::Random(n, n);
+    input.size = n;
+
+    Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(input.input_matrix);
+    std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
+
+    ShiftedQRSolver qrSolver(input);
+    qrSolver.solve();
+    OutputData output = qrSolver.getOutput();
+    std::vector<Eigen::dcomplex> sorted_qr = sort_eigenvalues(output.estimated_eigenvalues);
+
+    EXPECT_LT(output.iterations, input.num_iters);
+    for (int i=0; i<n; i++)
+    {
+        EXPECT_NEAR(std::abs(sorted_qr[i] - sorted_eigenvals[i]), 0.0, 1e-6);
+    }
+}
+
+TEST(Solver, NotCopyable)
+{
+    // The operator of a dense input references the matrix of its own solver
+    static_assert(!std::is_copy_constructible_v<PowerSolver>);
+    static_assert(!std::is_move_constructible_v<PowerSolver>);
+    static_assert(!std::is_copy_assignable_v<InverseSolver>);
+    static_assert(!std::is_move_assignable_v<InverseSolver>);
+}
+
+TEST(FrancisQRSolver, RealMatrices)
+{
+    for (int n : {1, 2, 3, 4, 10, 100})
+    {
+        InputData input;
+        input.num_iters = 2000;
+        input.tol = 1e-12;
+        input.input_matrix = Eigen::MatrixXd::Random(n, n).cast<Eigen::dcomplex>();
+        input.size = n;
+
+        Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(input.input_matrix);
+        std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
+
+        FrancisQRSolver qrSolver(input);
+        qrSolver.solve();
+        OutputData output = qrSolver.getOutput();
+        Eigen::VectorXcd eigenvals = output.estimated_eigenvalues;
+
+        EXPECT_LT(output.iterations, input.num_iters);
+        EXPECT_EQ(eigenvals.size(), n);
+        // Every computed eigenvalue matches a true one
+        for (int i=0; i<n; i++)
+        {
+            double dist = (true_solver.eigenvalues().array() - eigenvals[i]).abs().minCoeff();
+            EXPECT_NEAR(dist, 0.0, 1e-6);
+        }
+        // Same spectrum, conjugate pairs included
+        std::vector<Eigen::dcomplex> sorted_qr = sort_eigenvalues(eigenvals);
+        for (int i=0; i<n; i++)
+        {
+            EXPECT_NEAR(std::abs(sorted_qr[i]), std::abs(sorted_eigenvals[i]), 1e-6);
+        }
+    }
+}
+
+TEST(FrancisQRSolver, RotationHasComplexPair)
+{
+    InputData input;
+    input.num_iters = 100;
+    input.tol = 1e-12;
+    input.input_matrix = Eigen::MatrixXcd::Zero(3, 3);
+    input.input_matrix << 0, -1, 0,
+                          1,  0, 0,
+                          0,  0, 2;
+    input.size = 3;
+
+    FrancisQRSolver qrSolver(input);
+    qrSolver.solve();
+    std::vector<Eigen::dcomplex> eigenvals = sort_eigenvalues(qrSolver.getOutput().estimated_eigenvalues);
+
+    EXPECT_NEAR(eigenvals[0].real(), 2.0, 1e-10);
+    EXPECT_NEAR(std::abs(eigenvals[1].imag()), 1.0, 1e-10);
+    EXPECT_NEAR(eigenvals[1].real(), 0.0, 1e-10);
+    EXPECT_NEAR((eigenvals[1] - std::conj(eigenvals[2])).real(), 0.0, 1e-10);
+    EXPECT_NEAR((eigenvals[1] - std::conj(eigenvals[2])).imag(), 0.0, 1e-10);
+}
+
+TEST(HermitianSolver, HermitianMatrices)
+{
+    for (int n : {1, 4, 33, 100, 300})
+    {
+        Eigen::MatrixXcd B = Eigen::MatrixXcd::Random(n, n);
+        InputData input;
+        input.num_iters = 1;
+        input.tol = 1e-12;
+        input.input_matrix = B + B.adjoint();
+        input.size = n;
+        input.method_config["THREADS"] = 4;
+        ASSERT_TRUE(isHermitian(input.input_matrix));
+
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> true_solver(input.input_matrix);
+
+        HermitianSolver solver(input);
+        solver.solve();
+        OutputData output = solver.getOutput();
+
+        EXPECT_LT(output.estimated_error, 1e-10);
+        for (int i=0; i<n; i++)
+        {
+            EXPECT_NEAR(output.estimated_eigenvalues[i].real(), true_solver.eigenvalues()[i], 1e-9);
+            EXPECT_EQ(output.estimated_eigenvalues[i].imag(), 0.0);
+        }
+    }
+}
+
+TEST(HermitianSolver, RepeatedEigenvalues)
+{
+    // Identity plus a rank-2 term: heavy deflation in every merge
+    int n = 200;
+    Eigen::VectorXcd u = Eigen::VectorXcd::Random(n);
+    InputData input;
+    input.num_iters = 1;
+    input.tol = 1e-12;
+    input.input_matrix = Eigen::MatrixXcd::Identity(n, n) + u * u.adjoint();
+    input.size = n;
+    input.method_config["THREADS"] = 2;
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> true_solver(input.input_matrix);
+
+    HermitianSolver solver(input);
+    solver.solve();
+    OutputData output = solver.getOutput();
+
+    EXPECT_LT(output.estimated_error, 1e-10);
+    for (int i=0; i<n; i++)
+    {
+        EXPECT_NEAR(output.estimated_eigenvalues[i].real(), true_solver.eigenvalues()[i], 1e-9);
+    }
+}
+
+TEST(HermitianSolver, NonHermitianDetection)
+{
+    Matrices matrices;
+    EXPECT_TRUE(isHermitian(matrices.getSymmetric()));
+    EXPECT_TRUE(isHermitian(matrices.getIdentity()));
+    EXPECT_FALSE(isHermitian(matrices.getDiagonalComplex()));
+    EXPECT_FALSE(isHermitian(matrices.getRandom5()));
+}
+
+TEST_P(QRSolverTest, SolverArnoldi)
+{
+    // Input setup
+    int n = matrix.rows();
+    input.input_matrix = matrix;
+    input.size = n;
+    input.method_config["K"] = 2;
+    input.method_config["WHICH"] = "LM";
+
+    // True eigenvalues
+    Eigen::ComplexEigenSolver<Eigen::MatrixXcd> true_solver(matrix);
+    std::vector<Eigen::dcomplex> sorted_eigenvals = sort_eigenvalues(true_solver.eigenvalues());
+
+    ArnoldiSolver arnoldiSolver(input);
+    arnoldiSolver.solve();
+    Eigen::VectorXcd eigenvals = arnoldiSolver.getOutput().estimated_eigenvalues;
+
+    ASSERT_EQ(eigenvals.size(), 2);
+    for (int i=0; i<2; i++)
+    {
+        EXPECT_NEAR(std::abs(eigenvals[i]), std::abs(sorted_eigenvals[i]), 1e-2);
+    }
+}
+
+class ArnoldiSolverTest : public ::testing::TestWithParam<std::string> {
+protected:
+    void SetUp() override {
+        // Non-normal matrix with known spectrum, geometric towards both ends of the real
+        // axis so that the wanted eigenvalues are well separated for every WHICH
+        int n = 200;
+        Eigen::VectorXcd spectrum(n);
+        for (int i=0; i<n; i++) {
+            int t = i - n/2;
+            spectrum(i) = Eigen::dcomplex((t < 0 ? -1.0 : 1.0) * std::pow(1.03, std::abs(t)), 0.1 * std::sin(i));
+        }
+        Eigen::MatrixXcd S = Eigen::MatrixXcd::Identity(n, n) + 0.1 / std::sqrt(n) * Eigen::MatrixXcd::Random(n, n);
+        input.input_matrix = S * spectrum.asDiagonal() * S.inverse();
+        input.size = n;
+        input.num_iters = 500;
+        input.tol = 1e-9;
+        true_eigenvals = spectrum;
+    }
+    InputData input;
+    Eigen::VectorXcd true_eigenvals;
+};
+
+TEST_P(ArnoldiSolverTest, WantedEigenvalues)
+{
+    std::string which = GetParam();
+    int k = 6;
+    input.method_config["K"] = k;
+    input.method_config["KRYLOV_SIZE"] = 30;
+    input.method_config["WHICH"] = which;
+
+    std::vector<Eigen::dcomplex> expected(true_eigenvals.data(), true_eigenvals.data() + true_eigenvals.size());
+    std::sort(expected.begin(), expected.end(), [&](Eigen::dcomplex a, Eigen::dcomplex b) {
+        if (which == "LR") return a.real() > b.real();
+        if (which == "SR") return a.real() < b.real();
+        return std::abs(a) > std::abs(b);
+    });
+
+    ArnoldiSolver arnoldiSolver(input);
+    arnoldiSolver.solve();
+    OutputData output = arnoldiSolver.getOutput();
+
+    EXPECT_LT(output.iterations, input.num_iters);
+    EXPECT_LT(output.estimated_error, input.tol);
+    ASSERT_EQ(output.estimated_eigenvalues.size(), k);
+    for (int i=0; i<k; i++)
+    {
+        EXPECT_NEAR(std::abs(output.estimated_eigenvalues[i] - expected[i]), 0.0, 1e-6);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ArnoldiTestSuite,
+    ArnoldiSolverTest,
+    ::testing::Values("LM", "LR", "SR")
+);
+
+TEST(Factorization, AutomaticSelection)
+{
+    int n = 50;
+    Eigen::MatrixXcd B = Eigen::MatrixXcd::Random(n, n);
+    Eigen::MatrixXcd spd = B.adjoint()*B + n*Eigen::MatrixXcd::Identity(n, n);
+    Eigen::MatrixXcd indefinite = B + B.adjoint();
+    Eigen::MatrixXcd general = B;
+    Eigen::MatrixXcd rhs = Eigen::MatrixXcd::Random(n, 3);
+
+    std::vector<std::pair<Eigen::MatrixXcd, std::string>> cases = {
+        {spd, "LLT"}, {indefinite, "LDLT"}, {general, "LU"}
+    };
+    for (auto const& c : cases) {
+        std::unique_ptr<Factorization> f = createFactorization(c.first, "AUTO");
+        EXPECT_EQ(f->getName(), c.second);
+        EXPECT_LT((c.first*f->solve(rhs) - rhs).norm(), 1e-8*rhs.norm()*c.first.norm());
+    }
+
+    // Explicit choices that do not fit the matrix fall back
+    EXPECT_EQ(createFactorization(general, "LLT")->getName(), "LU");
+    EXPECT_EQ(createFactorization(indefinite, "LLT")->getName(), "LDLT");
+    EXPECT_EQ(createFactorization(spd, "LDLT")->getName(), "LDLT");
+    Eigen::MatrixXcd singular = Eigen::MatrixXcd::Zero(n, n);
+    singular.topLeftCorner(n/2, n/2) = spd.topLeftCorner(n/2, n/2);
+    EXPECT_EQ(createFactorization(singular, "AUTO")->getName(), "COD");
+}
+
+TEST(Factorization, InverseSolverReportsFactorization)
+{
+    int n = 40;
+    Eigen::MatrixXcd B = Eigen::MatrixXcd::Random(n, n);
+    InputData input;
+    input.input_matrix = B.adjoint()*B + Eigen::MatrixXcd::Identity(n, n);
+    input.size = n;
+    input.num_iters = 5000;
+    input.tol = 1e-10;
+    input.method_config["SHIFT"] = "0";
+
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> true_solver(input.input_matrix);
+    double smallest = true_solver.eigenvalues()[0];
+
+    for (std::string type : {"AUTO", "LU", "LDLT", "LLT"}) {
+        input.method_config["FACTORIZATION"] = type;
+        InverseSolver solver(input);
+        solver.solve();
+        OutputData out = solver.getOutput();
+        EXPECT_NEAR(out.estimated_eigenvalues[0].real(), smallest, 1e-6);
+        EXPECT_EQ(metricValue(out, "Factorization"), type == "AUTO" ? "LLT" : type);
+    }
+}
+
+TEST(PowerBasedSolver, InPlaceIterationWithCheckStride)
+{
+    // Hermitian matrix with eigenvalues 1, 2, ..., n
+    int n = 50;
+    InputData input = hermitianInput(Eigen::VectorXd::LinSpaced(n, 1, n), 5000, 1e-8);
+
+    for (int check_every : {1, 7}) {
+        input.method_config["CHECK_EVERY"] = check_every;
+        PowerSolver solver(input);
+        solver.solve();
+        OutputData out = solver.getOutput();
+        EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - Eigen::dcomplex(n, 0)), 0.0, 1e-6);
+        EXPECT_LT(out.estimated_error, 1e-8);
+        // Convergence is only checked every check_every iterations
+        EXPECT_EQ((out.iterations + 1) % check_every, 0);
+        EXPECT_EQ(out.metrics[0].first, "Convergence Checks");
+        EXPECT_EQ(std::stoi(out.metrics[0].second), (out.iterations + 1) / check_every);
+    }
+
+    input.method_config["SHIFT"] = "1.2";
+    input.method_config["FACTORIZATION"] = "LU";
+    InverseSolver inverse(input);
+    inverse.solve();
+    OutputData out = inverse.getOutput();
+    EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - Eigen::dcomplex(1, 0)), 0.0, 1e-6);
+}
+
+TEST(PowerBasedSolver, LoopAllocations)
+{
+    AllocationCounter count_allocations = allocationCounter();
+    if (!count_allocations) {
+        GTEST_SKIP() << "Allocations are not counted on this platform";
+    }
+    // The counter sees the allocations of Eigen
+    std::size_t before = count_allocations();
+    Eigen::VectorXcd v(10);
+    EXPECT_GT(count_allocations(), before);
+
+    // Hermitian matrix with eigenvalues 1, 2, ..., n
+    int n = 50;
+    InputData input = hermitianInput(Eigen::VectorXd::LinSpaced(n, 1, n), 5000, 1e-8);
+    for (std::string acceleration : {"NONE", "CHEBYSHEV", "MOMENTUM"}) {
+        input.method_config["ACCELERATION"] = acceleration;
+        input.method_config["SHIFT"] = "0";
+        input.method_config["BOUNDS"] = {1.0, n - 1.0};
+        PowerSolver power(input);
+        power.solve();
+        EXPECT_EQ(metricValue(power.getOutput(), "Loop Allocations"), "0") << acceleration;
+
+        input.method_config["SHIFT"] = "1.2";
+        input.method_config["BOUNDS"] = {2.0, n};
+        for (std::string type : {"LU", "LDLT"}) {
+            input.method_config["FACTORIZATION"] = type;
+            InverseSolver inverse(input);
+            inverse.solve();
+            EXPECT_EQ(metricValue(inverse.getOutput(), "Loop Allocations"), "0") << acceleration << type;
+        }
+    }
+}
+
+TEST(PowerBasedSolver, Acceleration)
+{
+    // Hermitian matrix with a dominant eigenvalue 10.5 close to the rest of the spectrum in [1, 10]
+    int n = 40;
+    Eigen::VectorXd eigenvals(n);
+    eigenvals << Eigen::VectorXd::LinSpaced(n - 1, 1, 10), 10.5;
+    InputData input = hermitianInput(eigenvals, 5000, 1e-8);
+    input.method_config["BOUNDS"] = {1, 10};
+    input.method_config["BETA"] = 25;
+
+    input.method_config["ACCELERATION"] = "NONE";
+    PowerSolver plain(input);
+    plain.solve();
+    int plain_iterations = plain.getOutput().iterations;
+    EXPECT_NEAR(std::abs(plain.getOutput().estimated_eigenvalues[0] - 10.5), 0.0, 1e-6);
+
+    for (std::string acceleration : {"AITKEN", "CHEBYSHEV", "MOMENTUM"}) {
+        input.method_config["ACCELERATION"] = acceleration;
+        PowerSolver solver(input);
+        solver.solve();
+        OutputData out = solver.getOutput();
+        EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - 10.5), 0.0, 1e-6) << acceleration;
+        EXPECT_LT(out.iterations, plain_iterations) << acceleration;
+        EXPECT_EQ(metricValue(out, "Acceleration"), acceleration);
+    }
+
+    // Shift beyond the spectrum, the bounds are mapped to the inverse
+    input.method_config["SHIFT"] = "11";
+    input.method_config["FACTORIZATION"] = "LU";
+    input.method_config["ACCELERATION"] = "NONE";
+    InverseSolver plain_inverse(input);
+    plain_inverse.solve();
+    input.method_config["ACCELERATION"] = "CHEBYSHEV";
+    InverseSolver inverse(input);
+    inverse.solve();
+    OutputData out = inverse.getOutput();
+    EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - 10.5), 0.0, 1e-6);
+    EXPECT_LT(out.iterations, plain_inverse.getOutput().iterations);
+
+    // A shift inside the bounds cannot be accelerated
+    input.method_config["SHIFT"] = "5.1";
+    InverseSolver inside(input);
+    inside.solve();
+    EXPECT_EQ(inside.getOutput().metrics.size(), 5);
+}
+
+TEST(PowerBasedSolver, ChebyshevRecurrence)
+{
+    // Two iterations from a given start give the Chebyshev polynomial T_2(t(A)) y_0
+    int n = 5;
+    Eigen::VectorXd eigenvals(n);
+    eigenvals << 1, 2, 3, 4, 6;
+    InputData input;
+    input.input_matrix = eigenvals.cast<Eigen::dcomplex>().asDiagonal();
+    input.size = n;
+    input.num_iters = 2;
+    input.tol = 1e-14;
+    input.initial_vectors = Eigen::VectorXcd::Ones(n);
+    input.method_config["SHIFT"] = "0";
+    input.method_config["ACCELERATION"] = "CHEBYSHEV";
+    input.method_config["BOUNDS"] = {1, 4};
+    PowerSolver solver(input);
+    solver.solve();
+
+    Eigen::ArrayXd t = (2*eigenvals.array() - 5) / 3;
+    Eigen::VectorXcd expected = (2*t.square() - 1).matrix().cast<Eigen::dcomplex>().normalized();
+    Eigen::VectorXcd v = solver.getOutput().estimated_eigenvectors.col(0);
+    EXPECT_NEAR(std::abs(expected.dot(v)), 1.0, 1e-12);
+}
+
+TEST(Factorization, HessenbergShiftedSolve)
+{
+    int n = 30;
+    Eigen::MatrixXcd M = Eigen::MatrixXcd::Random(n, n);
+    Eigen::VectorXcd b = Eigen::VectorXcd::Random(n);
+    HessenbergFactorization decomp;
+    ASSERT_TRUE(decomp.compute(M));
+    for (Eigen::dcomplex shift : {Eigen::dcomplex(0, 0), Eigen::dcomplex(0.5, -0.2), Eigen::dcomplex(-2, 1)}) {
+        ASSERT_TRUE(decomp.setShift(shift));
+        Eigen::VectorXcd x;
+        decomp.solveInto(b, x);
+        Eigen::MatrixXcd shifted = M - shift*Eigen::MatrixXcd::Identity(n, n);
+        EXPECT_LT((shifted*x - b).norm(), 1e-10 * b.norm());
+    }
+    EXPECT_EQ(decomp.getName(), "Hessenberg LU");
+}
+
+TEST(InverseSolver, RayleighQuotientIteration)
+{
+    // Hermitian matrix with eigenvalues 1, 2, ..., n and a shift poorly separating 37 from 38
+    int n = 100;
+    InputData input = hermitianInput(Eigen::VectorXd::LinSpaced(n, 1, n), 1000, 1e-10, "37.3");
+    input.method_config["FACTORIZATION"] = "LU";
+
+    InverseSolver fixed(input);
+    fixed.solve();
+    int fixed_iterations = fixed.getOutput().iterations;
+    EXPECT_NEAR(std::abs(fixed.getOutput().estimated_eigenvalues[0] - 37.0), 0.0, 1e-8);
+    EXPECT_GT(fixed_iterations, 20);
+
+    input.method_config["RAYLEIGH"] = true;
+    for (std::string rayleigh_solve : {"FACTORIZE", "HESSENBERG"}) {
+        for (int refactor_every : {1, 3}) {
+            input.method_config["RAYLEIGH_SOLVE"] = rayleigh_solve;
+            input.method_config["REFACTOR_EVERY"] = refactor_every;
+            InverseSolver solver(input);
+            solver.solve();
+            OutputData out = solver.getOutput();
+            EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - 37.0), 0.0, 1e-8) << rayleigh_solve << refactor_every;
+            EXPECT_LT(out.estimated_error, 1e-10);
+            EXPECT_LT(out.iterations, 12) << rayleigh_solve << refactor_every;
+            std::string shift_updates = metricValue(out, "Shift Updates");
+            ASSERT_FALSE(shift_updates.empty());
+            EXPECT_GT(std::stoi(shift_updates), 0);
+            EXPECT_EQ(metricValue(out, "Rayleigh Fallback"), "no");
+        }
+    }
+}
+
+TEST(PowerBasedSolver, AutomaticShift)
+{
+    // Hermitian matrices with poorly separated dominant and smallest eigenvalues
+    int n = 60;
+    Eigen::VectorXd dominant(n);
+    dominant << Eigen::VectorXd::LinSpaced(n - 1, 5, 10), 10.5;
+    InputData input = hermitianInput(dominant, 5000, 1e-8);
+    input.method_config["FACTORIZATION"] = "LU";
+
+    PowerSolver fixed_power(input);
+    fixed_power.solve();
+    input.method_config["SHIFT"] = "AUTO";
+    for (std::string acceleration : {"NONE", "CHEBYSHEV"}) {
+        input.method_config["ACCELERATION"] = acceleration;
+        PowerSolver power(input);
+        power.solve();
+        OutputData out = power.getOutput();
+        EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - 10.5), 0.0, 1e-6) << acceleration;
+        EXPECT_LT(2*out.iterations, fixed_power.getOutput().iterations) << acceleration;
+        std::string speedup = metricValue(out, "Predicted Speedup");
+        ASSERT_FALSE(speedup.empty());
+        EXPECT_GT(std::stod(speedup), 1.5);
+        EXPECT_FALSE(metricValue(out, "Automatic Shift").empty());
+    }
+
+    input.method_config["ACCELERATION"] = "NONE";
+    input.input_matrix = hermitianWithSpectrum(Eigen::VectorXd::LinSpaced(n, 2, 12));
+    input.method_config["SHIFT"] = "0";
+    InverseSolver fixed_inverse(input);
+    fixed_inverse.solve();
+    input.method_config["SHIFT"] = "AUTO";
+    InverseSolver inverse(input);
+    inverse.solve();
+    OutputData out = inverse.getOutput();
+    EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - 2.0), 0.0, 1e-6);
+    EXPECT_LT(2*out.iterations, fixed_inverse.getOutput().iterations);
+    EXPECT_FALSE(metricValue(out, "Automatic Shift").empty());
+    std::string speedup = metricValue(out, "Predicted Speedup");
+    ASSERT_FALSE(speedup.empty());
+    EXPECT_GT(std::stod(speedup), 1.5);
+    EXPECT_EQ(metricValue(out, "Factorization"), "LU");
+}
+
+TEST(Balancing, BadlyScaledMatrix)
+{
+    // Similarity with rows and columns scaled from 1e-6 to 1e6
+    int n = 40;
+    std::srand(7);
+    Eigen::MatrixXcd M = Eigen::MatrixXd::Random(n, n).cast<Eigen::dcomplex>();
+    M.diagonal().array() += Eigen::VectorXd::LinSpaced(n, 1, 4*n).cast<Eigen::dcomplex>().array();
+    Eigen::VectorXd S = Eigen::VectorXd::LinSpaced(n, -6, 6).unaryExpr([](double e) { return std::pow(10.0, e); });
+    Eigen::MatrixXcd A = S.asDiagonal() * M * S.cwiseInverse().asDiagonal();
+
+    // Powers of two, and the balanced matrix is exactly the similarity
+    Eigen::MatrixXcd B = A;
+    int sweeps;
+    Eigen::VectorXd D = balanceMatrix(B, sweeps);
+    for (int i=0; i<n; i++) {
+        int exponent;
+        EXPECT_EQ(std::frexp(D(i), &exponent), 0.5);
+        for (int j=0; j<n; j++) {
+            EXPECT_EQ(B(i, j), A(i, j) * D(j) / D(i));
+        }
+    }
+    EXPECT_LT(1e3 * B.norm(), A.norm());
+
+    // Hermitian matrices are already balanced
+    Eigen::MatrixXcd H = M + M.adjoint();
+    EXPECT_TRUE(balanceMatrix(H, sweeps).isOnes());
+    EXPECT_EQ(sweeps, 1);
+
+    // Same eigenvalues, eigenvectors of the input matrix
+    std::vector<Eigen::dcomplex> expected = sort_eigenvalues(Eigen::ComplexEigenSolver<Eigen::MatrixXcd>(M).eigenvalues());
+    InputData input;
+    input.size = n;
+    input.num_iters = 10000;
+    input.tol = 1e-10;
+    input.balance = true;
+    input.method = "SHIFTED_QR";
+    input.input_matrix = A;
+    std::unique_ptr<Solver> qr(createSolver(input));
+    qr->solve();
+    std::vector<Eigen::dcomplex> eigenvals = sort_eigenvalues(qr->getOutput().estimated_eigenvalues);
+    ASSERT_EQ(eigenvals.size(), n);
+    for (int i=0; i<n; i++) {
+        EXPECT_NEAR(std::abs(eigenvals[i] - expected[i]), 0.0, 1e-6 * std::abs(expected[i]));
+    }
+    EXPECT_EQ(qr->getOutput().metrics[0].first, "Balancing Time");
+    EXPECT_EQ(qr->getOutput().metrics[2].first, "Balancing Norm Reduction");
+    EXPECT_GT(std::stod(qr->getOutput().metrics[2].second), 1e3);
+
+    input.method = "POWER";
+    input.method_config["SHIFT"] = "0";
+    std::unique_ptr<Solver> power(createSolver(input));
+    power->solve();
+    OutputData out = power->getOutput();
+    EXPECT_NEAR(std::abs(out.estimated_eigenvalues[0] - expected[0]), 0.0, 1e-6 * std::abs(expected[0]));
+    Eigen::VectorXcd v = out.estimated_eigenvectors.col(0);
+    EXPECT_NEAR(v.norm(), 1.0, 1e-12);
+    EXPECT_LT((A*v - out.estimated_eigenvalues[0]*v).norm(), 1e-6 * A.norm());
+}
+
+TEST(Balancing, ExtremeScaling)
+{
+    // Balancing the off-diagonal entries would need a factor of about 1e310, which overflows
+    Eigen::MatrixXcd A(2, 2);
+    A << 0, 1e300,
+         1e-320, 0;
+    Eigen::MatrixXcd B = A;
+    int sweeps;
+    Eigen::VectorXd D = balanceMatrix(B, sweeps);
+    EXPECT_TRUE(D.allFinite());
+    EXPECT_GT(D.minCoeff(), 0.0);
+    EXPECT_TRUE(B.allFinite());
+    EXPECT_EQ(B.diagonal(), A.diagonal());
+    // The scaling stops inside the safe range, and still reduces the norm
+    EXPECT_LT(B.cwiseAbs().maxCoeff(), 1e-3 * A.cwiseAbs().maxCoeff());
+}
+
+TEST(MultiShiftSolver, ListAndGridShifts)
+{
+    // Hermitian matrix with eigenvalues 1, 2, ..., n
+    int n = 60;
+    InputData input = hermitianInput(Eigen::VectorXd::LinSpaced(n, 1, n), 1000, 1e-10);
+    input.method_config["SHIFTS"] = {"10.2", "9.9 + 0.1i", 30.3};
+    input.method_config["SHIFT_GRID"] = {{"REAL", {19.8, 20.4, 2}}};
+    input.method_config["THREADS"] = 3;
+
+    MultiShiftSolver solver(input);
+    solver.solve();
+    OutputData out = solver.getOutput();
+
+    // Both shifts near 10 and both grid points near 20 are merged
+    ASSERT_EQ(out.estimated_eigenvalues.size(), 3);
+    std::vector<double> expected = {10.0, 30.0, 20.0};
+    for (int i=0; i<3; i++) {
+        EXPECT_NEAR(std::abs(out.estimated_eigenvalues[i] - expected[i]), 0.0, 1e-8);
+    }
+    EXPECT_LT(out.estimated_error, 1e-10);
+    EXPECT_EQ(out.metrics[0].second, "5");
+
+    input.method_config.erase("SHIFTS");
+    input.method_config.erase("SHIFT_GRID");
+    EXPECT_THROW(MultiShiftSolver bad_solver(input), ConfigError);
+}
+
+TEST(LinearOperator, SparseInputMatchesDense)
+{
+    // Sparse tridiagonal matrix with dominant eigenvalue
+    int n = 500;
+    std::vector<Eigen::Triplet<Eigen::dcomplex>> entries;
+    for (int i=0; i<n; i++) {
+        entries.emplace_back(i, i, Eigen::dcomplex(2.0 + (i == n/2 ? 10.0 : 0.0), 0.5));
+        if (i+1 < n) {
+            entries.emplace_back(i, i+1, -1.0);
+            entries.emplace_back(i+1, i, -1.0);
+        }
+    }
+    Eigen::SparseMatrix<Eigen::dcomplex, Eigen::RowMajor> S(n, n);
+    S.setFromTriplets(entries.begin(), entries.end());
+
+    InputData sparse_input;
+    sparse_input.size = n;
+    sparse_input.num_iters = 2000;
+    sparse_input.tol = 1e-10;
+    sparse_input.op = std::make_shared<SparseOperator>(S);
+    sparse_input.method_config["SHIFT"] = "0";
+
+    InputData dense_input = sparse_input;
+    dense_input.op.reset();
+    dense_input.input_matrix = Eigen::MatrixXcd(S);
+
+    // Shifted operator applied implicitly
+    Eigen::VectorXcd x = Eigen::VectorXcd::Random(n), y(n);
+    ShiftedOperator shifted(sparse_input.op, Eigen::dcomplex(1.0, -1.0));
+    shifted.apply(x, y);
+    EXPECT_LT((y - (dense_input.input_matrix * x - Eigen::dcomplex(1.0, -1.0) * x)).norm(), 1e-12);
+
+    PowerSolver sparse_solver(sparse_input);
+    sparse_solver.solve();
+    PowerSolver dense_solver(dense_input);
+    dense_solver.solve();
+    Eigen::dcomplex sparse_val = sparse_solver.getOutput().estimated_eigenvalues[0];
+    Eigen::dcomplex dense_val = dense_solver.getOutput().estimated_eigenvalues[0];
+    EXPECT_NEAR(std::abs(sparse_val - dense_val), 0.0, 1e-8);
+    EXPECT_LT(sparse_solver.getOutput().estimated_error, 1e-10);
+
+    sparse_input.method_config["K"] = 3;
+    sparse_input.method_config["KRYLOV_SIZE"] = 20;
+    ArnoldiSolver arnoldi(sparse_input);
+    arnoldi.solve();
+    EXPECT_NEAR(std::abs(arnoldi.getOutput().estimated_eigenvalues[0] - dense_val), 0.0, 1e-8);
+}
+
+class SubspaceSolverTest : public ::testing::TestWithParam<std::tuple<bool, Eigen::dcomplex>> {
+protected:
+    void SetUp() override {
+        // Non-normal matrix with geometrically decaying spectrum
+        int n = 100;
+        spectrum.resize(n);
+        for (int i=0; i<n; i++) {
+            spectrum(i) = 100.0 * std::pow(0.9, i) * std::polar(1.0, 0.3 * i);
+        }
+        Eigen::MatrixXcd S = Eigen::MatrixXcd::Identity(n, n) + 0.1 / std::sqrt(n) * Eigen::MatrixXcd::Random(n, n);
+        input.input_matrix = S * spectrum.asDiagonal() * S.inverse();
+        input.size = n;
+        input.num_iters = 2000;
+        input.tol = 1e-9;
+    }
+    InputData input;
+    Eigen::VectorXcd spectrum;
+};
+
+TEST_P(SubspaceSolverTest, BlockEigenvalues)
+{
+    bool inverse = std::get<0>(GetParam());
+    Eigen::dcomplex shift = std::get<1>(GetParam());
+    int k = 4;
+    input.method_config["K"] = k;
+    input.method_config["SHIFT"] = std::to_string(shift.real()) + (shift.imag() < 0 ? "-" : "+")
+        + std::to_string(std::abs(shift.imag())) + "i";
+    input.method_config["INVERSE"] = inverse;
+
+    // Expected eigenvalues, ordered by distance to the shift
+    std::vector<Eigen::dcomplex> expected(spectrum.data(), spectrum.data() + spectrum.size());
+    std::sort(expected.begin(), expected.end(), [&](Eigen::dcomplex a, Eigen::dcomplex b) {
+        return inverse ? std::abs(a - shift) < std::abs(b - shift) : std::abs(a - shift) > std::abs(b - shift);
+    });
+
+    SubspaceSolver subspaceSolver(input);
+    subspaceSolver.solve();
+    OutputData output = subspaceSolver.getOutput();
+
+    EXPECT_LT(output.iterations, input.num_iters);
+    EXPECT_LT(output.estimated_error, input.tol);
+    ASSERT_EQ(output.estimated_eigenvalues.size(), k);
+    for (int i=0; i<k; i++)
+    {
+        EXPECT_NEAR(std::abs(output.estimated_eigenvalues[i] - expected[i]), 0.0, 1e-6);
+    }
+}
+
+TEST(SubspaceSolver, NumericShift)
+{
+    // A shift given as a plain number selects the eigenvalues nearest to it, as its string form
+    InputData input;
+    input.input_matrix = Eigen::VectorXd::LinSpaced(6, 1, 6).cast<Eigen::dcomplex>().asDiagonal();
+    input.size = 6;
+    input.num_iters = 1000;
+    input.tol = 1e-10;
+    input.method_config["K"] = 1;
+    input.method_config["INVERSE"] = true;
+    input.method_config["SHIFT"] = 4.2;
+    SubspaceSolver subspace(input);
+    subspace.solve();
+    EXPECT_NEAR(std::abs(subspace.getOutput().estimated_eigenvalues[0] - 4.0), 0.0, 1e-8);
+
+    input.method_config["SHIFT"] = 2.2;
+    InverseSolver inverse(input);
+    inverse.solve();
+    EXPECT_NEAR(std::abs(inverse.getOutput().estimated_eigenvalues[0] - 2.0), 0.0, 1e-8);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    SubspaceTestSuite,
+    SubspaceSolverTest,
+    ::testing::Values(
+        std::make_tuple(false, Eigen::dcomplex(0.0, 0.0)),
+        std::make_tuple(false, Eigen::dcomplex(-5.0, 2.0)),
+        std::make_tuple(true, Eigen::dcomplex(0.0, 0.0)),
+        std::make_tuple(true, Eigen::dcomplex(30.0, 10.0))
+    )
+);
+
 INSTANTIATE_TEST_SUITE_P(
     PowerBasedTestSuite,
     PowerBasedSolverTest,
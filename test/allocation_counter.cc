@@ -0,0 +1,42 @@
+#include <cstddef>
+#include "utils.h"
+
+// Counts the heap allocations of every thread of the test executable, for the "Loop Allocations"
+// metric of the solvers. Only linked into the tests: it replaces malloc, calloc and realloc of glibc
+// and leaves the other allocation functions and free to it, which only holds without a sanitizer
+// or a preloaded allocator.
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+// Constant-initialized, so that malloc can use it at any time
+static thread_local std::size_t thread_allocations = 0;
+
+extern "C" void * __libc_malloc(std::size_t size);
+extern "C" void * __libc_calloc(std::size_t count, std::size_t size);
+extern "C" void * __libc_realloc(void * pointer, std::size_t size);
+
+extern "C" void * malloc(std::size_t size) noexcept
+{
+    thread_allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void * calloc(std::size_t count, std::size_t size) noexcept
+{
+    thread_allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void * realloc(void * pointer, std::size_t size) noexcept
+{
+    thread_allocations++;
+    return __libc_realloc(pointer, size);
+}
+
+static std::size_t threadAllocations()
+{
+    return thread_allocations;
+}
+
+// Installed before the tests start
+static const bool counter_installed = (setAllocationCounter(threadAllocations), true);
+#endif
@@ -15,4 +15,29 @@ std::vector<std::complex<double>> sort_eigenvalues(Eigen::VectorXcd const& eigen
     std::sort(sorted_eigenvals.begin(), sorted_eigenvals.end(), compareMagnitude);
 
     return sorted_eigenvals;
-}
\ No newline at end of file
+}
+
+Eigen::MatrixXcd hermitianWithSpectrum(Eigen::VectorXd const& eigenvals)
+{
+    int n = eigenvals.size();
+    Eigen::HouseholderQR<Eigen::MatrixXcd> qr(Eigen::MatrixXcd::Random(n, n));
+    Eigen::MatrixXcd Q = qr.householderQ();
+    return Q * eigenvals.cast<std::complex<double>>().asDiagonal() * Q.adjoint();
+}
+
+InputData hermitianInput(Eigen::VectorXd const& eigenvals, int num_iters, double tol, std::string const& shift)
+{
+    InputData input;
+    input.input_matrix = hermitianWithSpectrum(eigenvals);
+    input.size = eigenvals.size();
+    input.num_iters = num_iters;
+    input.tol = tol;
+    input.method_config["SHIFT"] = shift;
+    return input;
+}
+
+std::string metricValue(OutputData const& output, std::string const& name)
+{
+    auto metric = std::find_if(output.metrics.begin(), output.metrics.end(), [&](auto const& m) { return m.first == name; });
+    return metric != output.metrics.end() ? metric->second : "";
+}
@@ -1,11 +1,59 @@
 #ifndef TEST_UTILS_H
 #define TEST_UTILS_H 
 
+#include <string>
 #include <vector>
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
+#include "InputData.h"
+#include "OutputData.h"
 
 bool compareMagnitude(std::complex<double> const& a, std::complex<double> const& b);
 std::vector<std::complex<double>> sort_eigenvalues(Eigen::VectorXcd const& eigenvals);
+// Random Hermitian matrix Q diag(eigenvals) Q^H, with Q unitary
+Eigen::MatrixXcd hermitianWithSpectrum(Eigen::VectorXd const& eigenvals);
+// Input with such a matrix, the iteration limit, the tolerance and the shift set
+InputData hermitianInput(Eigen::VectorXd const& eigenvals, int num_iters, double tol, std::string const& shift = "0");
+// Value of the metric with this name, empty if the output has none
+std::string metricValue(OutputData const& output, std::string const& name);
+
+// Small test matrices shared by the solver tests and the acceleration benchmark
+class Matrices
+{
+    public:
+        Matrices() {  
+            A_random3 = Eigen::MatrixXcd::Random(3, 3);
+            A_random5 = Eigen::MatrixXcd::Random(5, 5);
+            A_identity = Eigen::MatrixXcd::Identity(3, 3);
+            A_diagonal_real = Eigen::MatrixXcd::Zero(3, 3);
+            A_diagonal_real.diagonal() << Eigen::dcomplex(1.0, 0.0), 
+                Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(3.0, 0.0);
+            A_diagonal_complex = Eigen::MatrixXcd::Zero(3, 3);
+            A_diagonal_complex.diagonal() << Eigen::dcomplex(1.0, 1.0), 
+                Eigen::dcomplex(2.0, 7.0), Eigen::dcomplex(3.0, 4.0);
+            A_symmetric = Eigen::MatrixXcd::Zero(4,4);
+            A_symmetric << Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(3.0, 0.0), Eigen::dcomplex(1.0, 0.0), Eigen::dcomplex(4.0, 0.0),
+                           Eigen::dcomplex(3.0, 0.0), Eigen::dcomplex(5.0, 0.0), Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(6.0, 0.0),
+                           Eigen::dcomplex(1.0, 0.0), Eigen::dcomplex(2.0, 0.0), Eigen::dcomplex(8.0, 0.0), Eigen::dcomplex(7.0, 0.0),
+                           Eigen::dcomplex(4.0, 0.0), Eigen::dcomplex(6.0, 0.0), Eigen::dcomplex(7.0, 0.0), Eigen::dcomplex(9.0, 0.0);
+            
+        }
+        // Get matrices
+        Eigen::MatrixXcd getRandom3() const { return A_random3; }
+        Eigen::MatrixXcd getRandom5() const { return A_random5; }
+        Eigen::MatrixXcd getIdentity() const { return A_identity; }
+        Eigen::MatrixXcd getDiagonalReal() const { return A_diagonal_real; }
+        Eigen::MatrixXcd getDiagonalComplex() const { return A_diagonal_complex; }
+        Eigen::MatrixXcd getSymmetric() const { return A_symmetric; }
+
+    protected:
+        Eigen::MatrixXcd A_random3;
+        Eigen::MatrixXcd A_random5;
+        Eigen::MatrixXcd A_identity;
+        Eigen::MatrixXcd A_diagonal_real;
+        Eigen::MatrixXcd A_diagonal_flipped;
+        Eigen::MatrixXcd A_diagonal_complex;
+        Eigen::MatrixXcd A_symmetric;
+};
 
 #endif // TEST_UTILS_H
\ No newline at end of file